@@ -0,0 +1,98 @@
+#pragma once
+/*
+Bounded lock-free multi-producer/multi-consumer queue (Dmitry Vyukov's
+array-based design).
+
+Every cell carries a sequence number that tells producers and consumers
+whether it is free for the current lap of the ring, so a push or pop is one
+compare-and-swap on a shared position plus one release store on the cell.
+try_push fails when the queue is full and try_pop when it is empty; callers
+decide how to wait (see wait_backoff).
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <thread>
+
+template <class T>
+class BoundedQueue {
+public:
+    // capacity is rounded up to a power of two.
+    explicit BoundedQueue(std::size_t capacity){
+        std::size_t size = 2;
+        while (size < capacity){
+            size *= 2;
+        }
+        mask_ = size - 1;
+        cells_.reset(new Cell[size]);
+        for (std::size_t i = 0; i < size; ++i){
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    bool try_push(const T& value){
+        std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;){
+            Cell& cell = cells_[pos & mask_];
+            const std::size_t seq = cell.seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0){
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                    cell.value = value;
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0){
+                return false;   // full
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool try_pop(T& value){
+        std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;){
+            Cell& cell = cells_[pos & mask_];
+            const std::size_t seq = cell.seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0){
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                    value = cell.value;
+                    cell.seq.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0){
+                return false;   // empty
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> seq;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    std::size_t mask_ = 0;
+    // Separate cache lines so producers and consumers do not false-share.
+    alignas(64) std::atomic<std::size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<std::size_t> dequeue_pos_{0};
+};
+
+// Waiting strategy for a failed try_push/try_pop: spin briefly with yields,
+// then sleep, so a stalled stage does not burn a core.
+inline void wait_backoff(unsigned& attempts){
+    if (++attempts < 64){
+        std::this_thread::yield();
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,241 @@
+#pragma once
+/*
+Allocation-free CSV parsing for large inventory extracts.
+
+Records are read into one large reusable buffer and split into
+std::string_view fields that point straight into it, so a row costs no heap
+allocation once the buffers have grown to the longest row. Quoted fields
+("Widget, large", "say ""hi""") are supported; only a quoted field that
+contains an escaped quote is copied, into a per-record scratch string.
+Numbers are converted with std::from_chars (no locale, no exceptions).
+*/
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+// Fields of one record. The views stay valid until the next call that
+// reuses the record (CsvReader::next or parse_csv_record).
+struct CsvRecord {
+    std::vector<std::string_view> fields;
+    std::string scratch;   // unescaped copies of fields containing ""
+
+    std::size_t size() const { return fields.size(); }
+    std::string_view operator[](std::size_t i) const { return fields[i]; }
+};
+
+// Splits one record (without its line terminator) into fields.
+// Returns false if a quoted field is not closed.
+inline bool parse_csv_record(std::string_view line, CsvRecord& record, char delimiter = ','){
+    record.fields.clear();
+    record.scratch.clear();
+    // Unescaped text is never longer than the raw record, so reserving that
+    // much up front keeps earlier views into scratch from being invalidated.
+    record.scratch.reserve(line.size());
+
+    std::size_t i = 0;
+    for (;;){
+        if (i < line.size() && line[i] == '"'){
+            const std::size_t start = ++i;
+            bool escaped = false;
+            for (;;){
+                const std::size_t quote = line.find('"', i);
+                if (quote == std::string_view::npos){
+                    return false;
+                }
+                if (quote + 1 < line.size() && line[quote + 1] == '"'){
+                    escaped = true;
+                    i = quote + 2;
+                    continue;
+                }
+                i = quote;
+                break;
+            }
+            std::string_view raw = line.substr(start, i - start);
+            if (escaped){
+                const std::size_t begin = record.scratch.size();
+                for (std::size_t k = 0; k < raw.size(); ++k){
+                    record.scratch += raw[k];
+                    if (raw[k] == '"'){
+                        ++k;   // skip the second quote of the pair
+                    }
+                }
+                raw = std::string_view(record.scratch).substr(begin);
+            }
+            record.fields.push_back(raw);
+            ++i;   // closing quote
+            // Anything between the closing quote and the delimiter is ignored.
+            const std::size_t next = line.find(delimiter, i);
+            if (next == std::string_view::npos){
+                return true;
+            }
+            i = next + 1;
+        } else {
+            const std::size_t next = line.find(delimiter, i);
+            if (next == std::string_view::npos){
+                record.fields.push_back(line.substr(i));
+                return true;
+            }
+            record.fields.push_back(line.substr(i, next - i));
+            i = next + 1;
+        }
+    }
+}
+
+inline std::string_view trim_spaces(std::string_view text){
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')){
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')){
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+// Converts the whole of text (surrounding spaces allowed) to a number.
+// Returns false instead of throwing when text is not a valid number.
+template <class Number>
+bool parse_number(std::string_view text, Number& value){
+    text = trim_spaces(text);
+    if (!text.empty() && text.front() == '+'){
+        text.remove_prefix(1);
+    }
+    if (text.empty()){
+        return false;
+    }
+    const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+// Reads CSV records from a file through one large buffer.
+class CsvReader {
+public:
+    explicit CsvReader(const std::string& path, char delimiter = ',',
+                       std::size_t buffer_size = std::size_t{1} << 20)
+        : file_(path, std::ios::binary), delimiter_(delimiter),
+          buffer_(new char[buffer_size]), capacity_(buffer_size) {}
+
+    bool is_open() const { return file_.is_open(); }
+
+    // Line number (1-based) of the record last returned by next().
+    std::uint64_t line_number() const { return line_number_; }
+
+    // Reads the next non-empty record. Returns false at end of input. A
+    // record with an unterminated quote is returned as-is up to the end of
+    // its last line, and malformed() reports it.
+    bool next(CsvRecord& record){
+        for (;;){
+            std::size_t end = 0;
+            while (!find_record_end(end)){
+                if (!refill()){
+                    if (begin_ == filled_){
+                        return false;
+                    }
+                    end = filled_;   // last record without a trailing newline
+                    break;
+                }
+            }
+            std::string_view line(buffer_.get() + begin_, end - begin_);
+            line_number_ = next_line_;
+            next_line_ += newlines_ + 1;
+            begin_ = end < filled_ ? end + 1 : end;
+            start_record();
+            if (!line.empty() && line.back() == '\r'){
+                line.remove_suffix(1);
+            }
+            if (line.empty()){
+                continue;
+            }
+            malformed_ = !parse_csv_record(line, record, delimiter_);
+            return true;
+        }
+    }
+
+    bool malformed() const { return malformed_; }
+
+private:
+    // Finds the newline ending the record at begin_, skipping newlines that
+    // are inside quoted fields. As in parse_csv_record, a quote only opens a
+    // field at its start, so the inch mark in `12" Ruler` is plain text. The
+    // scan resumes where it stopped after a refill, so each byte is looked
+    // at once however long the record is.
+    bool find_record_end(std::size_t& end){
+        for (; scan_ < filled_; ++scan_){
+            const char c = buffer_[scan_];
+            if (quoted_){
+                if (c == '"'){
+                    quoted_ = false;
+                    closed_quote_ = true;
+                } else if (c == '\n'){
+                    ++newlines_;
+                }
+                continue;
+            }
+            if (c == '\n'){
+                end = scan_;
+                return true;
+            }
+            // Opens a quoted field, or is the second quote of an escaped "".
+            if (c == '"' && (field_start_ || closed_quote_)){
+                quoted_ = true;
+            }
+            field_start_ = c == delimiter_;
+            closed_quote_ = false;
+        }
+        return false;
+    }
+
+    void start_record(){
+        scan_ = begin_;
+        newlines_ = 0;
+        quoted_ = false;
+        field_start_ = true;
+        closed_quote_ = false;
+    }
+
+    // Moves the unread tail to the front (growing the buffer if one record
+    // fills it) and reads more. Returns false at end of file.
+    bool refill(){
+        if (!file_){
+            return false;
+        }
+        const std::size_t tail = filled_ - begin_;
+        if (begin_ == 0 && tail == capacity_){
+            std::unique_ptr<char[]> bigger(new char[capacity_ * 2]);
+            std::copy(buffer_.get(), buffer_.get() + tail, bigger.get());
+            buffer_ = std::move(bigger);
+            capacity_ *= 2;
+        } else {
+            std::copy(buffer_.get() + begin_, buffer_.get() + filled_, buffer_.get());
+        }
+        scan_ -= begin_;
+        begin_ = 0;
+        filled_ = tail;
+        file_.read(buffer_.get() + filled_, static_cast<std::streamsize>(capacity_ - filled_));
+        const auto got = static_cast<std::size_t>(file_.gcount());
+        filled_ += got;
+        return got > 0;
+    }
+
+    std::ifstream file_;
+    char delimiter_;
+    std::unique_ptr<char[]> buffer_;
+    std::size_t capacity_;
+    std::size_t begin_ = 0;
+    std::size_t filled_ = 0;
+    // Scan state of the record at begin_.
+    std::size_t scan_ = 0;
+    std::size_t newlines_ = 0;
+    bool quoted_ = false;
+    bool field_start_ = true;
+    bool closed_quote_ = false;
+    std::uint64_t line_number_ = 0;
+    std::uint64_t next_line_ = 1;
+    bool malformed_ = false;
+};
\ No newline at end of file
@@ -0,0 +1,95 @@
+/*
+Checks CsvReader against parse_csv_record: a file read record by record must
+split into the same records and fields as its lines parsed one by one, for
+buffers small enough that every record straddles a refill.
+
+Usage: csv_reader_test   (exits with 1 and lists the failures if any)
+*/
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "csv_reader.h"
+
+struct Expected {
+    std::uint64_t line;
+    std::vector<std::string> fields;
+};
+
+struct Case {
+    const char* name;
+    std::string text;
+    std::vector<Expected> records;
+};
+
+int failures = 0;
+
+void fail(const Case& c, std::size_t buffer, const std::string& what) {
+    std::cerr << c.name << " (buffer " << buffer << "): " << what << std::endl;
+    ++failures;
+}
+
+void check(const Case& c, std::size_t buffer) {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "csv_reader_test.csv";
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << c.text;
+    }
+    CsvReader reader(path.string(), ',', buffer);
+    CsvRecord record;
+    std::size_t r = 0;
+    while (reader.next(record)) {
+        if (r == c.records.size()) {
+            fail(c, buffer, "unexpected record at line " + std::to_string(reader.line_number()));
+            break;
+        }
+        const Expected& expected = c.records[r++];
+        if (reader.line_number() != expected.line) {
+            fail(c, buffer, "record " + std::to_string(r) + " at line " + std::to_string(reader.line_number()) +
+                 ", expected " + std::to_string(expected.line));
+        }
+        std::vector<std::string> fields(record.fields.begin(), record.fields.end());
+        if (fields != expected.fields) {
+            std::string got;
+            for (const std::string& field : fields) {
+                got += "[" + field + "]";
+            }
+            fail(c, buffer, "record " + std::to_string(r) + " split as " + got);
+        }
+    }
+    if (r != c.records.size()) {
+        fail(c, buffer, std::to_string(r) + " records, expected " + std::to_string(c.records.size()));
+    }
+    std::filesystem::remove(path);
+}
+
+int main() {
+    const std::vector<Case> cases = {
+        {"plain lines", "Laptop,5,999.99\nMouse,12,29.99\n",
+         {{1, {"Laptop", "5", "999.99"}}, {2, {"Mouse", "12", "29.99"}}}},
+        {"inch mark inside a field", "12\" Ruler,5,3.00\nTape,2,1.50\n9\" Nails,100,0.05",
+         {{1, {"12\" Ruler", "5", "3.00"}}, {2, {"Tape", "2", "1.50"}}, {3, {"9\" Nails", "100", "0.05"}}}},
+        {"quoted delimiter and newline", "\"Widget, large\",3,4.00\n\"Two\nlines\",1,2.00\nLast,1,1.00\n",
+         {{1, {"Widget, large", "3", "4.00"}}, {2, {"Two\nlines", "1", "2.00"}}, {4, {"Last", "1", "1.00"}}}},
+        {"escaped quotes", "\"say \"\"hi\"\"\",1,1.00\n\"\"\"\n\"\"\",2,2.00\n",
+         {{1, {"say \"hi\"", "1", "1.00"}}, {2, {"\"\n\"", "2", "2.00"}}}},
+        {"text after a closing quote", "\"a\"x\"b,1\nc,2\n",
+         {{1, {"a", "1"}}, {2, {"c", "2"}}}},
+        {"blank and CRLF lines", "\r\nA,1\r\n\nB,2\r\n",
+         {{2, {"A", "1"}}, {4, {"B", "2"}}}},
+    };
+    for (const Case& c : cases) {
+        for (std::size_t buffer : {std::size_t{1}, std::size_t{3}, std::size_t{7}, std::size_t{1} << 20}) {
+            check(c, buffer);
+        }
+    }
+    if (failures > 0) {
+        std::cerr << failures << " failures" << std::endl;
+        return 1;
+    }
+    std::cout << "All " << cases.size() << " CSV reader cases passed" << std::endl;
+    return 0;
+}
\ No newline at end of file
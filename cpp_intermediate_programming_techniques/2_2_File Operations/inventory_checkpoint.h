@@ -0,0 +1,188 @@
+#pragma once
+/*
+Checkpoint for incremental summaries of an append-only inventory file.
+
+The sidecar records how far into the inventory file the summary has got, the
+running totals at that point, and where the totals footer starts in the
+summary file. An update then parses only the bytes appended since, truncates
+the summary just before its footer, appends the new product lines and writes
+a fresh footer, so its cost follows the size of the new data.
+
+A checkpoint is only trusted while both files still look like the ones it
+describes: the inventory must be at least as long as the processed prefix
+and end that prefix with the same bytes, and the summary must have the size
+recorded after the last update. Anything else means a full rebuild.
+*/
+
+#include "inventory_ingest.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+constexpr int kCheckpointVersion = 2;
+
+struct InventoryCheckpoint {
+    std::uint64_t input_offset = 0;     // bytes of the inventory already summarised
+    std::uint64_t input_tail_hash = 0;  // hash of the bytes just before input_offset
+    long long rows = 0;
+    long long totalItems = 0;
+    Money totalValue;
+    std::uint64_t summary_footer = 0;   // offset of the footer in the summary file
+    std::uint64_t summary_size = 0;     // summary file size after the last update
+};
+
+// FNV-1a over the last (up to) 64 bytes before offset.
+inline std::uint64_t hash_tail(const char* data, std::uint64_t offset){
+    const std::uint64_t begin = offset > 64 ? offset - 64 : 0;
+    std::uint64_t h = 14695981039346656037ull;
+    for (std::uint64_t i = begin; i < offset; ++i){
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// Reads a checkpoint written by save_checkpoint. Returns false if the file is
+// missing, not a checkpoint of this version, or has a field that is missing,
+// repeated or not a number, so a damaged sidecar forces a rebuild.
+inline bool load_checkpoint(const std::string& path, InventoryCheckpoint& ckpt){
+    std::ifstream in(path);
+    std::string magic;
+    int version = 0;
+    if (!(in >> magic >> version) || magic != "inventory-checkpoint" || version != kCheckpointVersion){
+        return false;
+    }
+    std::string key;
+    std::string value_text;
+    unsigned seen = 0;   // one bit per field
+    while (in >> key){
+        if (!(in >> value_text)){
+            return false;
+        }
+        bool parsed = false;
+        unsigned field = 0;
+        if (key == "input_offset"){
+            parsed = parse_number(value_text, ckpt.input_offset);
+            field = 1u << 0;
+        } else if (key == "input_tail_hash"){
+            parsed = parse_number(value_text, ckpt.input_tail_hash);
+            field = 1u << 1;
+        } else if (key == "rows"){
+            parsed = parse_number(value_text, ckpt.rows);
+            field = 1u << 2;
+        } else if (key == "total_items"){
+            parsed = parse_number(value_text, ckpt.totalItems);
+            field = 1u << 3;
+        } else if (key == "total_value"){
+            // Money units, so the total reloads exactly.
+            std::int64_t units = 0;
+            parsed = parse_number(value_text, units);
+            ckpt.totalValue = Money::from_units(units);
+            field = 1u << 4;
+        } else if (key == "summary_footer"){
+            parsed = parse_number(value_text, ckpt.summary_footer);
+            field = 1u << 5;
+        } else if (key == "summary_size"){
+            parsed = parse_number(value_text, ckpt.summary_size);
+            field = 1u << 6;
+        }
+        if (!parsed || (seen & field) != 0){
+            return false;
+        }
+        seen |= field;
+    }
+    return seen == (1u << 7) - 1;
+}
+
+// Writes ckpt to path through a temporary file, so an interrupted update
+// leaves either the old checkpoint or the new one.
+inline void save_checkpoint(const std::string& path, const InventoryCheckpoint& ckpt){
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        out << "inventory-checkpoint " << kCheckpointVersion << '\n'
+            << "input_offset " << ckpt.input_offset << '\n'
+            << "input_tail_hash " << ckpt.input_tail_hash << '\n'
+            << "rows " << ckpt.rows << '\n'
+            << "total_items " << ckpt.totalItems << '\n'
+            << "total_value " << ckpt.totalValue.units() << '\n'
+            << "summary_footer " << ckpt.summary_footer << '\n'
+            << "summary_size " << ckpt.summary_size << '\n';
+        if (!out.flush()){
+            throw std::runtime_error("cannot write " + tmp);
+        }
+    }
+    std::filesystem::rename(tmp, path);
+}
+
+// Whether ckpt still describes input (mapped, input_size bytes) and summary.
+inline bool checkpoint_matches(const InventoryCheckpoint& ckpt, const char* input, std::uint64_t input_size,
+                               const std::string& summary){
+    std::error_code ec;
+    const std::uint64_t summary_size = std::filesystem::file_size(summary, ec);
+    return !ec && summary_size == ckpt.summary_size && ckpt.summary_footer <= summary_size
+        && ckpt.input_offset <= input_size && hash_tail(input, ckpt.input_offset) == ckpt.input_tail_hash;
+}
+
+inline std::string checkpoint_path(const std::string& summary){
+    return summary + ".ckpt";
+}
+
+// Brings summary up to date with input using its checkpoint, or rebuilds it
+// from the start of input when there is no usable checkpoint (rebuilt is then
+// set). Only complete lines are consumed; an unterminated last line is left
+// for a later update, once its newline has been appended, and pending
+// receives its length in bytes (0 if input ends with a newline). Returns the
+// totals of the lines parsed by this call; ckpt receives the running totals.
+inline InventoryChunk
+update_summary_incremental(const std::string& input, const std::string& summary, unsigned threads,
+                           InventoryCheckpoint& ckpt, bool& rebuilt, std::uint64_t& pending){
+    const std::string ckpt_file = checkpoint_path(summary);
+    const MappedInventory file(input);
+    rebuilt = !load_checkpoint(ckpt_file, ckpt) || !checkpoint_matches(ckpt, file.data(), file.size(), summary);
+
+    std::uint64_t end = file.size();
+    while (end > 0 && file.data()[end - 1] != '\n'){
+        --end;
+    }
+    if (rebuilt){
+        ckpt = InventoryCheckpoint{};
+    } else {
+        // Drop the old footer; the product lines before it stay as they are.
+        std::filesystem::resize_file(summary, ckpt.summary_footer);
+    }
+    if (end < ckpt.input_offset){
+        end = ckpt.input_offset;
+    }
+
+    ReportWriter out(summary, !rebuilt);
+    if (!out.is_open()){
+        throw std::runtime_error("cannot open " + summary);
+    }
+    if (rebuilt){
+        out.text("INVENTORY SUMMARY\n=================\n");
+    }
+    const std::uint64_t kept = rebuilt ? 0 : ckpt.summary_footer;
+    const InventoryChunk added = ingest_inventory_range(file.data() + ckpt.input_offset, end - ckpt.input_offset,
+                                                        threads, [&](const InventoryChunk& chunk){
+        out.text(chunk.report);
+    });
+    ckpt.summary_footer = kept + out.bytes_written();
+    ckpt.rows += added.rows;
+    ckpt.totalItems += added.totalItems;
+    ckpt.totalValue += added.totalValue;
+    ckpt.input_offset = end;
+    pending = file.size() - end;
+    ckpt.input_tail_hash = hash_tail(file.data(), end);
+
+    out.text("\nTotal Items: ").integer(ckpt.totalItems).newline();
+    out.text("Total Value: $").money(ckpt.totalValue).newline();
+    out.close();
+    ckpt.summary_size = std::filesystem::file_size(summary);
+    save_checkpoint(ckpt_file, ckpt);
+    return added;
+}
\ No newline at end of file
@@ -11,11 +11,58 @@ Modify the CSV data and re-run to see how the summary changes.
 
 #include <iostream>
 #include <fstream>
+#include <iomanip>
 #include <string>
+#include <chrono>
 #include <filesystem>
-int main() {
+#include <cstdint>
+#include <memory>
+#include "csv_reader.h"
+#include "inventory_ingest.h"
+#include "inventory_pipeline.h"
+#include "inventory_top.h"
+#include "inventory_checkpoint.h"
+#include "money.h"
+#include "report_writer.h"
+
+// Usage: inventory_file_ops [-j N] [--mmap | --stream | --incremental | --top N]
+//   -j N           parse with N threads (default: all cores)
+//   --mmap         map the whole file instead of streaming it through a
+//                  bounded reader/parser pipeline
+//   --stream       read through CsvReader on one thread; needed when quoted
+//                  fields contain newlines
+//   --incremental  only parse lines appended since the last run, using the
+//                  checkpoint in summary.txt.ckpt; a last line without its
+//                  newline is reported and left for the next run
+//   --top N        write only the N most valuable lines (quantity * price)
+//                  to top_products.txt, in O(N) memory
+int main(int argc, char* argv[]) {
     const std::string inputFile = "inventory.txt";
     const std::string outputFile = "summary.txt";    
+    unsigned threads = 0;
+    std::string mode;   // empty: pipeline
+    std::size_t topCount = 0;
+    auto usage = [&]() {
+        std::cerr << "Usage: " << argv[0] << " [-j N] [--mmap | --stream | --incremental | --top N]" << std::endl;
+        return 1;
+    };
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            if (!parse_number(argv[++i], threads)) {
+                return usage();
+            }
+        } else if ((arg == "--mmap" || arg == "--stream" || arg == "--incremental") && mode.empty()) {
+            mode = arg.substr(2);
+        } else if (arg == "--top" && i + 1 < argc && mode.empty()) {
+            mode = "top";
+            if (!parse_number(argv[++i], topCount)) {
+                return usage();
+            }
+        } else {
+            return usage();
+        }
+    }
     // Check if input file exists using C++17 filesystem
     if (!std::filesystem::exists(inputFile)) {
         std::cout << "Creating sample inventory file..." << std::endl;        
@@ -25,44 +72,142 @@ int main() {
         createFile << "Widget C,15,8.75" << std::endl;
         createFile.close();
     }    
-    // Read inventory data
-    std::ifstream inFile(inputFile);
-    if (!inFile.is_open()) {
-        std::cerr << "Error opening inventory file" << std::endl;
+    if (mode == "incremental") {
+        try {
+            const auto start = std::chrono::steady_clock::now();
+            InventoryCheckpoint ckpt;
+            bool rebuilt = false;
+            std::uint64_t pending = 0;
+            const InventoryChunk added = update_summary_incremental(inputFile, outputFile, threads, ckpt, rebuilt,
+                                                                    pending);
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if (added.malformed > 0) {
+                std::cerr << "Skipped " << added.malformed << " malformed lines" << std::endl;
+            }
+            std::cout << (rebuilt ? "Inventory summary rebuilt!" : "Inventory summary updated!") << std::endl;
+            std::cout << "Check summary.txt for results." << std::endl;    
+            std::cout << "Parsed " << added.rows << " new rows (" << ckpt.rows << " total) in " << std::fixed
+                      << std::setprecision(3) << elapsed.count() << " s" << std::endl;
+            if (pending > 0) {
+                std::cout << "Left " << pending << " bytes of an unterminated last line for the next update"
+                          << std::endl;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (mode == "top") {
+        try {
+            const auto start = std::chrono::steady_clock::now();
+            long long malformed = 0;
+            const std::vector<TopProduct> top = top_products_parallel(inputFile, topCount, threads, &malformed);
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if (malformed > 0) {
+                std::cerr << "Skipped " << malformed << " malformed lines" << std::endl;
+            }
+            ReportWriter topFile("top_products.txt");
+            if (!topFile.is_open()) {
+                std::cerr << "Error creating top products file" << std::endl;
+                return 1;
+            }
+            const std::string title = "TOP " + std::to_string(topCount) + " PRODUCTS BY VALUE";
+            topFile.text(title).newline();
+            topFile.text(std::string(title.size(), '=')).newline();
+            for (const TopProduct& product : top) {
+                topFile.append([&](std::string& out) {
+                    append_product_line(out, product.name, product.quantity, product.value);
+                });
+            }
+            topFile.close();
+            std::cout << "Top products completed!" << std::endl;
+            std::cout << "Check top_products.txt for results." << std::endl;
+            std::cout << "Ranked in " << std::fixed << std::setprecision(3) << elapsed.count() << " s" << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    // Open the input before the summary is truncated, so an unreadable
+    // inventory leaves the previous summary in place
+    std::unique_ptr<CsvReader> reader;
+    std::unique_ptr<MappedInventory> mapped;
+    std::ifstream pipelineInput;
+    try {
+        if (mode == "stream") {
+            reader = std::make_unique<CsvReader>(inputFile);
+            if (!reader->is_open()) {
+                std::cerr << "Error opening inventory file" << std::endl;
+                return 1;
+            }
+        } else if (mode == "mmap") {
+            mapped = std::make_unique<MappedInventory>(inputFile);
+        } else {
+            open_pipeline_input(pipelineInput, inputFile);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
         return 1;
-    }    
+    }
     // Process and summarize
-    std::ofstream outFile(outputFile);
-    if (!outFile) {
+    // Lines are formatted into a large buffer and written in big blocks
+    ReportWriter outFile(outputFile);
+    if (!outFile.is_open()) {
         std::cerr << "Error creating summary file" << std::endl;
         return 1;
     }    
-    outFile << "INVENTORY SUMMARY" << std::endl;
-    outFile << "=================" << std::endl;    
-    std::string line;
-    int totalItems = 0;
-    double totalValue = 0.0;    
-    while (std::getline(inFile, line)) {
-        // Simple CSV parsing (find commas)
-        size_t firstComma = line.find(',');
-        size_t secondComma = line.find(',', firstComma + 1);        
-        if (firstComma != std::string::npos && secondComma != std::string::npos) {
-            std::string name = line.substr(0, firstComma);
-            int quantity = std::stoi(line.substr(firstComma + 1, secondComma - firstComma - 1));
-            double price = std::stod(line.substr(secondComma + 1));            
-            totalItems += quantity;
-            totalValue += quantity * price;            
-            outFile << "Product: " << name << ", Qty: " << quantity
-                    << ", Value: $" << std::fixed << std::setprecision(2)
-                    << quantity * price << std::endl;
+    InventoryChunk totals;
+    std::chrono::duration<double> elapsed{};
+    try {
+        outFile.text("INVENTORY SUMMARY").newline();
+        outFile.text("=================").newline();    
+        const auto start = std::chrono::steady_clock::now();
+        if (mode == "stream") {
+            CsvRecord record;
+            // Fields are string_views into the reader's buffer: no per-row copies
+            while (reader->next(record)) {
+                int quantity = 0;
+                Money price;
+                if (reader->malformed() || !parse_inventory_record(record, quantity, price)) {
+                    std::cerr << "Skipping malformed line " << reader->line_number() << std::endl;
+                    continue;
+                }
+                const Money value = price * quantity;
+                ++totals.rows;
+                totals.totalItems += quantity;
+                totals.totalValue += value;            
+                outFile.append([&](std::string& out) {
+                    append_product_line(out, record[0], quantity, value);
+                });
+            }    
+        } else {
+            // Chunks arrive in file order, so the report keeps the input's order
+            const auto write_chunk = [&](const InventoryChunk& chunk) {
+                outFile.text(chunk.report);
+            };
+            totals = mode == "mmap" ? ingest_inventory_range(mapped->data(), mapped->size(), threads, write_chunk)
+                                    : run_inventory_pipeline(pipelineInput, threads, write_chunk);
+            if (totals.malformed > 0) {
+                std::cerr << "Skipped " << totals.malformed << " malformed lines" << std::endl;
+            }
         }
-    }    
-    outFile << std::endl << "Total Items: " << totalItems << std::endl;
-    outFile << "Total Value: $" << std::fixed << std::setprecision(2) << totalValue << std::endl;    
-    inFile.close();
-    outFile.close();    
+        elapsed = std::chrono::steady_clock::now() - start;
+        outFile.newline();
+        outFile.text("Total Items: ").integer(totals.totalItems).newline();
+        outFile.text("Total Value: $").money(totals.totalValue).newline();    
+        outFile.close();    
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
     std::cout << "Inventory summary completed!" << std::endl;
     std::cout << "Check summary.txt for results." << std::endl;    
+    std::cout << "Parsed " << totals.rows << " rows in " << std::fixed << std::setprecision(3) << elapsed.count() << " s ("
+              << std::setprecision(0) << (elapsed.count() > 0 ? totals.rows / elapsed.count() : 0.0)
+              << " rows/s)" << std::endl;
+
     return 0;
 }
 
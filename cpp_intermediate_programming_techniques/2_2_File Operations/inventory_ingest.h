@@ -0,0 +1,276 @@
+#pragma once
+/*
+Parallel ingest of large inventory files (name,quantity,price per line).
+
+The file is memory-mapped and cut into fixed-size chunks whose boundaries are
+moved forward to the next newline, so every line belongs to exactly one chunk.
+Worker threads parse chunks independently; the caller receives each chunk's
+report text and partial totals strictly in file order, and the totals are
+added in that same order. Values are exact Money amounts, so the totals do
+not depend on the chunk layout or the thread count either.
+
+Records are split on '\n' only, so a quoted field containing a newline is not
+supported here; use CsvReader for such files.
+*/
+
+#include "csv_reader.h"
+#include "money.h"
+#include "report_writer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr std::size_t kIngestChunkSize = std::size_t{16} << 20;
+
+// Parses quantity and price from an inventory record.
+inline bool parse_inventory_record(const CsvRecord& record, int& quantity, Money& price){
+    return record.size() >= 3 && parse_number(record[1], quantity) && Money::try_parse(record[2], price);
+}
+
+// Appends one "Product: ..." line of the summary report.
+inline void append_product_line(std::string& out, std::string_view name, int quantity, Money value){
+    out += "Product: ";
+    out.append(name.data(), name.size());
+    out += ", Qty: ";
+    append_integer(out, quantity);
+    out += ", Value: $";
+    append_money(out, value);
+    out += '\n';
+}
+
+// Read-only mapping of a whole file.
+class MappedInventory {
+public:
+    explicit MappedInventory(const std::string& path){
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0){
+            throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) != 0){
+            const int err = errno;
+            ::close(fd);
+            throw std::runtime_error("cannot stat " + path + ": " + std::strerror(err));
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        if (size_ > 0){
+            void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED){
+                const int err = errno;
+                ::close(fd);
+                throw std::runtime_error("cannot map " + path + ": " + std::strerror(err));
+            }
+            ::madvise(p, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(p);
+        }
+        ::close(fd);
+    }
+    ~MappedInventory(){
+        if (data_ != nullptr){
+            ::munmap(const_cast<char*>(data_), size_);
+        }
+    }
+    MappedInventory(MappedInventory&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+    MappedInventory& operator=(MappedInventory&& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        return *this;
+    }
+    MappedInventory(const MappedInventory&) = delete;
+    MappedInventory& operator=(const MappedInventory&) = delete;
+
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+// Start offsets of chunks of roughly chunk_size bytes, each one just after a
+// newline; the last entry is size.
+inline std::vector<std::size_t>
+split_at_newlines(const char* data, std::size_t size, std::size_t chunk_size){
+    std::vector<std::size_t> bounds{0};
+    std::size_t pos = 0;
+    while (size - pos > chunk_size){
+        const void* nl = std::memchr(data + pos + chunk_size, '\n', size - pos - chunk_size);
+        if (nl == nullptr){
+            break;
+        }
+        pos = static_cast<std::size_t>(static_cast<const char*>(nl) - data) + 1;
+        if (pos < size){
+            bounds.push_back(pos);
+        }
+    }
+    bounds.push_back(size);
+    return bounds;
+}
+
+struct InventoryChunk {
+    long long rows = 0;
+    long long totalItems = 0;
+    Money totalValue;
+    long long malformed = 0;
+    std::string report;   // "Product: ..." lines of this chunk, in file order
+};
+
+// Calls on_record(name, quantity, price) for every well-formed line in
+// data[0, size) and returns the number of malformed lines.
+template <class OnRecord>
+long long for_each_inventory_record(const char* data, std::size_t size, OnRecord&& on_record){
+    CsvRecord record;
+    long long malformed = 0;
+    const char* p = data;
+    const char* end = data + size;
+    while (p < end){
+        const void* nl = std::memchr(p, '\n', static_cast<std::size_t>(end - p));
+        const char* line_end = nl != nullptr ? static_cast<const char*>(nl) : end;
+        std::string_view line(p, static_cast<std::size_t>(line_end - p));
+        p = line_end + 1;
+        if (!line.empty() && line.back() == '\r'){
+            line.remove_suffix(1);
+        }
+        if (line.empty()){
+            continue;
+        }
+        int quantity = 0;
+        Money price;
+        if (!parse_csv_record(line, record) || !parse_inventory_record(record, quantity, price)){
+            ++malformed;
+            continue;
+        }
+        on_record(record[0], quantity, price);
+    }
+    return malformed;
+}
+
+// Parses the lines in data[0, size) into chunk.
+inline void parse_inventory_chunk(const char* data, std::size_t size, InventoryChunk& chunk){
+    chunk.report.reserve(size + size / 2);
+    chunk.malformed += for_each_inventory_record(data, size, [&](std::string_view name, int quantity, Money price){
+        const Money value = price * quantity;
+        ++chunk.rows;
+        chunk.totalItems += quantity;
+        chunk.totalValue += value;
+        append_product_line(chunk.report, name, quantity, value);
+    });
+}
+
+// Parses the lines in data[0, size) on up to threads workers and hands every
+// chunk to on_chunk in file order, from the calling thread. Returns the
+// merged totals (with an empty report). At most two chunks per worker are
+// held in memory at once.
+inline InventoryChunk
+ingest_inventory_range(const char* data, std::size_t size, unsigned threads,
+                       const std::function<void(const InventoryChunk&)>& on_chunk,
+                       std::size_t chunk_size = kIngestChunkSize){
+    const std::vector<std::size_t> bounds = split_at_newlines(data, size, chunk_size);
+    const std::size_t chunks = bounds.size() - 1;
+    if (threads == 0){
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = static_cast<unsigned>(std::min<std::size_t>(threads, chunks));
+    const std::size_t window = std::size_t{2} * std::max(1u, threads);
+
+    std::vector<InventoryChunk> results(chunks);
+    std::vector<char> done(chunks, 0);
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::size_t next_chunk = 0;   // next chunk a worker may claim
+    std::size_t delivered = 0;    // chunks already handed to on_chunk
+    std::exception_ptr failure;
+
+    auto worker = [&]{
+        for (;;){
+            std::size_t i;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                // Backpressure: stay at most `window` chunks ahead of the consumer.
+                changed.wait(lock, [&]{ return next_chunk >= chunks || next_chunk < delivered + window || failure; });
+                if (next_chunk >= chunks || failure){
+                    return;
+                }
+                i = next_chunk++;
+            }
+            InventoryChunk chunk;
+            try {
+                parse_inventory_chunk(data + bounds[i], bounds[i + 1] - bounds[i], chunk);
+            } catch (...){
+                std::lock_guard<std::mutex> lock(mutex);
+                failure = std::current_exception();
+                changed.notify_all();
+                return;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            results[i] = std::move(chunk);
+            done[i] = 1;
+            changed.notify_all();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t){
+        pool.emplace_back(worker);
+    }
+
+    InventoryChunk total;
+    try {
+        for (std::size_t i = 0; i < chunks; ++i){
+            InventoryChunk chunk;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&]{ return done[i] || failure; });
+                if (failure){
+                    break;
+                }
+                chunk = std::move(results[i]);
+            }
+            on_chunk(chunk);
+            total.rows += chunk.rows;
+            total.totalItems += chunk.totalItems;
+            total.totalValue += chunk.totalValue;
+            total.malformed += chunk.malformed;
+            std::lock_guard<std::mutex> lock(mutex);
+            ++delivered;
+            changed.notify_all();
+        }
+    } catch (...){
+        std::lock_guard<std::mutex> lock(mutex);
+        failure = std::current_exception();
+        changed.notify_all();
+    }
+    for (std::thread& t : pool){
+        t.join();
+    }
+    if (failure){
+        std::rethrow_exception(failure);
+    }
+    return total;
+}
+
+// Maps path and ingests the whole file with ingest_inventory_range.
+inline InventoryChunk
+ingest_inventory_parallel(const std::string& path, unsigned threads,
+                          const std::function<void(const InventoryChunk&)>& on_chunk,
+                          std::size_t chunk_size = kIngestChunkSize){
+    const MappedInventory file(path);
+    return ingest_inventory_range(file.data(), file.size(), threads, on_chunk, chunk_size);
+}
\ No newline at end of file
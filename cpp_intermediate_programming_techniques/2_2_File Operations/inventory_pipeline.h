@@ -0,0 +1,235 @@
+#pragma once
+/*
+Three-stage pipeline for inventory summaries:
+
+    reader thread --> N parser threads --> aggregator (calling thread)
+
+The reader fills large blocks from the file and cuts each one after its last
+newline, carrying the partial line into the next block. Parsers turn blocks
+into InventoryChunk results, and the aggregator hands the results to the
+caller in file order. Stages talk through bounded lock-free queues that
+carry block indices only.
+
+Memory is bounded by a fixed pool of 2 * N + 2 blocks: the reader can only
+read into a block the aggregator has given back, so a slow disk leaves the
+parsers idle and a slow writer pauses the reader instead of piling up data.
+*/
+
+#include "bounded_queue.h"
+#include "inventory_ingest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+constexpr std::size_t kPipelineBlockSize = std::size_t{4} << 20;
+
+struct PipelineBlock {
+    std::vector<char> data;   // grows past the block size only for longer lines
+    std::size_t size = 0;
+    std::uint64_t seq = 0;    // position of the block in the file
+    InventoryChunk result;    // reused, so its report keeps its capacity
+};
+
+// Opens path for run_inventory_pipeline, unbuffered since blocks are read
+// straight into place. Throws std::runtime_error if it cannot be opened.
+inline void open_pipeline_input(std::ifstream& in, const std::string& path){
+    in.rdbuf()->pubsetbuf(nullptr, 0);
+    in.open(path, std::ios::binary);
+    if (!in.is_open()){
+        throw std::runtime_error("cannot open " + path);
+    }
+}
+
+// Summarises in (opened with open_pipeline_input) through the pipeline with
+// parsers worker threads (0 = one per core), calling on_chunk for every block
+// in file order from the calling thread. Returns the merged totals.
+inline InventoryChunk
+run_inventory_pipeline(std::istream& in, unsigned parsers,
+                       const std::function<void(const InventoryChunk&)>& on_chunk,
+                       std::size_t block_size = kPipelineBlockSize){
+    if (parsers == 0){
+        parsers = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    constexpr std::uint32_t kStop = UINT32_MAX;
+    const std::size_t pool = std::size_t{2} * parsers + 2;
+    std::vector<PipelineBlock> blocks(pool);
+    BoundedQueue<std::uint32_t> free_blocks(pool);
+    BoundedQueue<std::uint32_t> to_parse(pool + parsers);
+    BoundedQueue<std::uint32_t> parsed(pool);
+    for (std::uint32_t b = 0; b < pool; ++b){
+        free_blocks.try_push(b);
+    }
+
+    std::atomic<bool> abort{false};
+    std::atomic<std::uint64_t> block_count{UINT64_MAX};   // known once the reader is done
+    std::mutex failure_mutex;
+    std::exception_ptr failure;
+    auto fail = [&](std::exception_ptr error){
+        std::lock_guard<std::mutex> lock(failure_mutex);
+        if (!failure){
+            failure = error;
+        }
+        abort.store(true);
+    };
+    // Waits until queue accepts/yields a value; false if the pipeline aborted.
+    auto push = [&](BoundedQueue<std::uint32_t>& queue, std::uint32_t value){
+        for (unsigned attempts = 0; !queue.try_push(value); wait_backoff(attempts)){
+            if (abort.load(std::memory_order_relaxed)){
+                return false;
+            }
+        }
+        return true;
+    };
+    auto pop = [&](BoundedQueue<std::uint32_t>& queue, std::uint32_t& value){
+        for (unsigned attempts = 0; !queue.try_pop(value); wait_backoff(attempts)){
+            if (abort.load(std::memory_order_relaxed)){
+                return false;
+            }
+        }
+        return true;
+    };
+
+    std::thread reader([&]{
+        std::uint64_t seq = 0;
+        try {
+            std::vector<char> carry;   // partial last line of the previous block
+            bool eof = false;
+            while (!eof){
+                std::uint32_t b;
+                if (!pop(free_blocks, b)){
+                    break;
+                }
+                PipelineBlock& block = blocks[b];
+                if (block.data.size() < std::max(block_size, carry.size() + 1)){
+                    block.data.resize(std::max(block_size, carry.size() * 2));
+                }
+                std::copy(carry.begin(), carry.end(), block.data.begin());
+                block.size = carry.size();
+                carry.clear();
+                for (;;){
+                    while (block.size < block.data.size() && !eof){
+                        in.read(block.data.data() + block.size, static_cast<std::streamsize>(block.data.size() - block.size));
+                        block.size += static_cast<std::size_t>(in.gcount());
+                        if (!in){
+                            if (in.bad()){
+                                throw std::runtime_error("error reading inventory input");
+                            }
+                            eof = true;
+                        }
+                    }
+                    if (eof){
+                        break;   // the rest of the file, newline or not
+                    }
+                    const std::size_t nl = std::string_view(block.data.data(), block.size).rfind('\n');
+                    if (nl != std::string_view::npos){
+                        carry.assign(block.data.begin() + static_cast<std::ptrdiff_t>(nl + 1),
+                                     block.data.begin() + static_cast<std::ptrdiff_t>(block.size));
+                        block.size = nl + 1;
+                        break;
+                    }
+                    block.data.resize(block.data.size() * 2);   // one line longer than a block
+                }
+                if (block.size == 0){
+                    free_blocks.try_push(b);
+                    break;
+                }
+                block.seq = seq++;
+                if (!push(to_parse, b)){
+                    break;
+                }
+            }
+        } catch (...){
+            fail(std::current_exception());
+        }
+        block_count.store(seq);
+        for (unsigned p = 0; p < parsers; ++p){
+            push(to_parse, kStop);
+        }
+    });
+
+    std::vector<std::thread> workers;
+    for (unsigned p = 0; p < parsers; ++p){
+        workers.emplace_back([&]{
+            std::uint32_t b;
+            while (pop(to_parse, b) && b != kStop){
+                PipelineBlock& block = blocks[b];
+                InventoryChunk& result = block.result;
+                result.rows = result.totalItems = result.malformed = 0;
+                result.totalValue = Money();
+                result.report.clear();
+                try {
+                    parse_inventory_chunk(block.data.data(), block.size, result);
+                } catch (...){
+                    fail(std::current_exception());
+                    return;
+                }
+                if (!push(parsed, b)){
+                    return;
+                }
+            }
+        });
+    }
+
+    // Aggregator: results can finish out of order, so park each one in the
+    // ring slot for its sequence number until its turn comes. At most `pool`
+    // blocks are in flight, so the ring never wraps onto a waiting block.
+    InventoryChunk total;
+    try {
+        std::vector<std::uint32_t> ring(pool, kStop);
+        std::uint64_t next = 0;
+        unsigned attempts = 0;
+        while (next < block_count.load() && !abort.load()){
+            std::uint32_t& slot = ring[next % pool];
+            if (slot != kStop){
+                const PipelineBlock& block = blocks[slot];
+                on_chunk(block.result);
+                total.rows += block.result.rows;
+                total.totalItems += block.result.totalItems;
+                total.totalValue += block.result.totalValue;
+                total.malformed += block.result.malformed;
+                free_blocks.try_push(slot);   // never full: the pool has `pool` blocks
+                slot = kStop;
+                ++next;
+                attempts = 0;
+                continue;
+            }
+            std::uint32_t b;
+            if (parsed.try_pop(b)){
+                ring[blocks[b].seq % pool] = b;
+                attempts = 0;
+            } else {
+                wait_backoff(attempts);
+            }
+        }
+    } catch (...){
+        fail(std::current_exception());
+    }
+    reader.join();
+    for (std::thread& t : workers){
+        t.join();
+    }
+    if (failure){
+        std::rethrow_exception(failure);
+    }
+    return total;
+}
+
+inline InventoryChunk
+run_inventory_pipeline(const std::string& path, unsigned parsers,
+                       const std::function<void(const InventoryChunk&)>& on_chunk,
+                       std::size_t block_size = kPipelineBlockSize){
+    std::ifstream in;
+    open_pipeline_input(in, path);
+    return run_inventory_pipeline(in, parsers, on_chunk, block_size);
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+/*
+Load inventory.txt once into a columnar table and answer aggregate queries
+against it, one per line on standard input. The table is kept in a binary
+snapshot (inventory.txt.snap) that later runs map instead of re-parsing the
+text; it is rebuilt whenever inventory.txt changes.
+
+    total-qty
+    total-value
+    bands 10 20 50      value by price band, split at the given prices
+    products            value per distinct product name
+    quit
+
+Build with optimisation so the aggregate loops are vectorised:
+    g++ -std=c++17 -O3 -march=native inventory_query.cpp -o inventory_query
+*/
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "inventory_snapshot.h"
+
+int main(int argc, char* argv[]) {
+    const std::string inputFile = argc > 1 ? argv[1] : "inventory.txt";
+    std::optional<InventorySnapshot> table;
+    try {
+        const auto start = std::chrono::steady_clock::now();
+        bool rebuilt = false;
+        std::size_t skipped = 0;
+        table.emplace(open_inventory(inputFile, &rebuilt, &skipped));
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << (rebuilt ? "Imported " : "Opened snapshot of ") << table->size() << " rows ("
+                  << table->distinct_names() << " distinct products) in " << std::fixed
+                  << std::setprecision(3) << elapsed.count() << " s" << std::endl;
+        if (skipped > 0) {
+            std::cerr << "Skipped " << skipped << " malformed lines" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    const InventoryColumns& columns = table->columns();
+
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        std::istringstream in(line);
+        std::string command;
+        if (!(in >> command)) {
+            continue;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        // Money sums throw on overflow; a failed query reports it and the
+        // next one is read.
+        try {
+            if (command == "total-qty") {
+                std::cout << "Total Items: " << columns.total_quantity() << std::endl;
+            } else if (command == "total-value") {
+                const Money total = columns.total_value();
+                std::cout << "Total Value: $" << to_string(total) << std::endl;
+            } else if (command == "bands") {
+                std::vector<Money> edges;
+                std::string edge;
+                while (in >> edge) {
+                    edges.push_back(Money::parse(edge));
+                }
+                const std::vector<Money> bands = columns.value_by_price_band(edges);
+                for (std::size_t b = 0; b < bands.size(); ++b) {
+                    if (edges.empty()) {
+                        std::cout << "all prices";
+                    } else if (b == 0) {
+                        std::cout << "price < " << to_string(edges[0]);
+                    } else if (b == edges.size()) {
+                        std::cout << "price >= " << to_string(edges[b - 1]);
+                    } else {
+                        std::cout << to_string(edges[b - 1]) << " <= price < " << to_string(edges[b]);
+                    }
+                    std::cout << ": $" << to_string(bands[b]) << std::endl;
+                }
+            } else if (command == "products") {
+                const std::vector<Money> values = columns.value_by_name();
+                for (std::uint32_t id = 0; id < values.size(); ++id) {
+                    std::cout << "Product: " << table->dictionary(id) << ", Value: $"
+                              << to_string(values[id]) << std::endl;
+                }
+            } else if (command == "quit") {
+                break;
+            } else {
+                std::cerr << "Unknown query: " << command << std::endl;
+                continue;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            continue;
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cerr << "(" << std::setprecision(6) << elapsed.count() << " s)" << std::endl;
+    }
+    return 0;
+}
\ No newline at end of file
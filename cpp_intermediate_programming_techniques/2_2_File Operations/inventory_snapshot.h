@@ -0,0 +1,260 @@
+#pragma once
+/*
+Binary snapshot of an InventoryTable, reopened with mmap instead of parsing.
+
+Layout (native byte order, every section 64-byte aligned):
+
+    SnapshotHeader
+    name_id   uint32[rows]
+    quantity  int32[rows]
+    price     int64[rows]         Money units
+    offsets   uint64[names + 1]   byte range of each name in the heap
+    heap      name bytes
+
+The header records the size and modification time of the text file the
+snapshot was built from, and the largest name id and quantity and price
+magnitudes, so opening needs no pass over the columns. The text file stays the source of truth:
+open_inventory() rebuilds the snapshot whenever either of them changes, or
+when the snapshot is missing or unreadable.
+*/
+
+#include "inventory_ingest.h"
+#include "inventory_store.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+constexpr char kSnapshotMagic[8] = {'I', 'N', 'V', 'S', 'N', 'A', 'P', '1'};
+constexpr std::uint32_t kSnapshotVersion = 3;
+
+// Identifies the version of the text file a snapshot was built from.
+struct SourceStamp {
+    std::uint64_t size = 0;
+    std::int64_t mtime = 0;   // file_time_type ticks
+
+    bool operator==(const SourceStamp& other) const { return size == other.size && mtime == other.mtime; }
+    bool operator!=(const SourceStamp& other) const { return !(*this == other); }
+};
+
+inline SourceStamp source_stamp(const std::string& path){
+    SourceStamp stamp;
+    stamp.size = std::filesystem::file_size(path);
+    stamp.mtime = static_cast<std::int64_t>(std::filesystem::last_write_time(path).time_since_epoch().count());
+    return stamp;
+}
+
+struct SnapshotHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t header_size;
+    std::uint64_t rows;
+    std::uint64_t names;
+    std::uint64_t source_size;
+    std::int64_t source_mtime;
+    std::uint64_t name_id_offset;
+    std::uint64_t quantity_offset;
+    std::uint64_t price_offset;
+    std::uint64_t offsets_offset;
+    std::uint64_t heap_offset;
+    std::uint64_t heap_size;
+    std::uint64_t max_name_id;
+    std::uint64_t max_quantity;   // largest |quantity|
+    std::uint64_t max_price;      // largest |price|, Money units
+    std::uint8_t reserved[8];
+};
+static_assert(sizeof(SnapshotHeader) == 128, "snapshot header layout changed");
+
+namespace snapshot_detail {
+
+inline std::uint64_t align64(std::uint64_t offset){
+    return (offset + 63) & ~std::uint64_t{63};
+}
+
+inline void write_at(std::ofstream& out, std::uint64_t offset, const void* data, std::size_t size){
+    static const char zeros[64] = {};
+    const auto pos = static_cast<std::uint64_t>(out.tellp());
+    out.write(zeros, static_cast<std::streamsize>(offset - pos));
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+}
+
+} // namespace snapshot_detail
+
+// Writes table to path, going through a temporary file so a reader never
+// sees a partly written snapshot.
+inline void write_inventory_snapshot(const InventoryTable& table, const SourceStamp& stamp,
+                                     const std::string& path){
+    using snapshot_detail::align64;
+    const InventoryColumns cols = table.columns();
+
+    std::vector<std::uint64_t> offsets;
+    offsets.reserve(cols.names + 1);
+    std::uint64_t heap_size = 0;
+    offsets.push_back(0);
+    for (std::uint32_t id = 0; id < cols.names; ++id){
+        heap_size += table.dictionary(id).size();
+        offsets.push_back(heap_size);
+    }
+
+    SnapshotHeader header {};
+    std::memcpy(header.magic, kSnapshotMagic, sizeof header.magic);
+    header.version = kSnapshotVersion;
+    header.header_size = sizeof(SnapshotHeader);
+    header.rows = cols.rows;
+    header.names = cols.names;
+    header.source_size = stamp.size;
+    header.source_mtime = stamp.mtime;
+    header.name_id_offset = align64(sizeof(SnapshotHeader));
+    header.quantity_offset = align64(header.name_id_offset + cols.rows * sizeof(std::uint32_t));
+    header.price_offset = align64(header.quantity_offset + cols.rows * sizeof(std::int32_t));
+    header.offsets_offset = align64(header.price_offset + cols.rows * sizeof(std::int64_t));
+    header.heap_offset = align64(header.offsets_offset + offsets.size() * sizeof(std::uint64_t));
+    header.heap_size = heap_size;
+    for (std::size_t i = 0; i < cols.rows; ++i){
+        header.max_name_id = std::max<std::uint64_t>(header.max_name_id, cols.name_id[i]);
+        header.max_quantity = std::max(header.max_quantity, magnitude(cols.quantity[i]));
+        header.max_price = std::max(header.max_price, magnitude(cols.price[i]));
+    }
+
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out){
+            throw std::runtime_error("cannot create " + tmp);
+        }
+        using snapshot_detail::write_at;
+        write_at(out, 0, &header, sizeof header);
+        write_at(out, header.name_id_offset, cols.name_id, cols.rows * sizeof(std::uint32_t));
+        write_at(out, header.quantity_offset, cols.quantity, cols.rows * sizeof(std::int32_t));
+        write_at(out, header.price_offset, cols.price, cols.rows * sizeof(std::int64_t));
+        write_at(out, header.offsets_offset, offsets.data(), offsets.size() * sizeof(std::uint64_t));
+        write_at(out, header.heap_offset, nullptr, 0);
+        for (std::uint32_t id = 0; id < cols.names; ++id){
+            const std::string_view name = table.dictionary(id);
+            out.write(name.data(), static_cast<std::streamsize>(name.size()));
+        }
+        if (!out.flush()){
+            throw std::runtime_error("cannot write " + tmp);
+        }
+    }
+    std::filesystem::rename(tmp, path);
+}
+
+// A snapshot file mapped read-only. The columns point straight into the
+// mapping; opening parses nothing and does not touch the row data, only the
+// header and the name offsets.
+class InventorySnapshot {
+public:
+    explicit InventorySnapshot(const std::string& path) : file_(path){
+        if (file_.size() < sizeof(SnapshotHeader)){
+            throw std::runtime_error(path + ": not an inventory snapshot");
+        }
+        std::memcpy(&header_, file_.data(), sizeof header_);
+        if (std::memcmp(header_.magic, kSnapshotMagic, sizeof header_.magic) != 0
+            || header_.version != kSnapshotVersion || header_.header_size != sizeof(SnapshotHeader)){
+            throw std::runtime_error(path + ": not an inventory snapshot");
+        }
+        check_section(path, header_.name_id_offset, header_.rows, sizeof(std::uint32_t), alignof(std::uint32_t));
+        check_section(path, header_.quantity_offset, header_.rows, sizeof(std::int32_t), alignof(std::int32_t));
+        check_section(path, header_.price_offset, header_.rows, sizeof(std::int64_t), alignof(std::int64_t));
+        check_section(path, header_.offsets_offset, header_.names + 1, sizeof(std::uint64_t), alignof(std::uint64_t));
+        check_section(path, header_.heap_offset, header_.heap_size, 1, 1);
+
+        columns_.name_id = section<std::uint32_t>(header_.name_id_offset);
+        columns_.quantity = section<std::int32_t>(header_.quantity_offset);
+        columns_.price = section<std::int64_t>(header_.price_offset);
+        columns_.rows = header_.rows;
+        columns_.names = header_.names;
+        offsets_ = section<std::uint64_t>(header_.offsets_offset);
+        heap_ = file_.data() + header_.heap_offset;
+
+        // Validate what later lookups index with, so a damaged file fails
+        // here rather than reading out of bounds.
+        if (offsets_[0] != 0 || offsets_[header_.names] != header_.heap_size){
+            throw std::runtime_error(path + ": corrupt name heap");
+        }
+        for (std::uint64_t id = 0; id < header_.names; ++id){
+            if (offsets_[id] > offsets_[id + 1]){
+                throw std::runtime_error(path + ": corrupt name heap");
+            }
+        }
+        if (header_.rows > 0 && header_.max_name_id >= header_.names){
+            throw std::runtime_error(path + ": corrupt name id column");
+        }
+        columns_.sums_fit = value_sums_fit(header_.max_quantity, header_.max_price, columns_.rows);
+    }
+
+    SourceStamp source() const { return SourceStamp{header_.source_size, header_.source_mtime}; }
+
+    const InventoryColumns& columns() const { return columns_; }
+    std::size_t size() const { return columns_.rows; }
+    std::size_t distinct_names() const { return columns_.names; }
+
+    std::string_view dictionary(std::uint32_t id) const {
+        return std::string_view(heap_ + offsets_[id], offsets_[id + 1] - offsets_[id]);
+    }
+    std::string_view name(std::size_t row) const { return dictionary(columns_.name_id[row]); }
+
+private:
+    void check_section(const std::string& path, std::uint64_t offset, std::uint64_t count,
+                       std::uint64_t width, std::uint64_t align) const {
+        const std::uint64_t size = file_.size();
+        if (offset % align != 0 || offset > size || count > (size - offset) / width){
+            throw std::runtime_error(path + ": truncated or corrupt snapshot");
+        }
+    }
+
+    template <class T>
+    const T* section(std::uint64_t offset) const {
+        return reinterpret_cast<const T*>(file_.data() + offset);
+    }
+
+    MappedInventory file_;
+    SnapshotHeader header_ {};
+    InventoryColumns columns_;
+    const std::uint64_t* offsets_ = nullptr;
+    const char* heap_ = nullptr;
+};
+
+inline std::string snapshot_path(const std::string& text_path){
+    return text_path + ".snap";
+}
+
+// Opens the snapshot for text_path, first rebuilding it from the text file
+// if it is missing, unreadable or was built from a different version of the
+// text. rebuilt (if given) reports whether the text was parsed.
+inline InventorySnapshot open_inventory(const std::string& text_path, bool* rebuilt = nullptr,
+                                        std::size_t* skipped = nullptr){
+    const std::string snap = snapshot_path(text_path);
+    const SourceStamp stamp = source_stamp(text_path);
+    if (rebuilt != nullptr){
+        *rebuilt = false;
+    }
+    if (skipped != nullptr){
+        *skipped = 0;
+    }
+    if (std::filesystem::exists(snap)){
+        try {
+            InventorySnapshot snapshot(snap);
+            if (snapshot.source() == stamp){
+                return snapshot;
+            }
+        } catch (const std::runtime_error&){
+            // Fall through and rebuild.
+        }
+    }
+    const InventoryTable table = InventoryTable::load(text_path);
+    write_inventory_snapshot(table, stamp, snap);
+    if (rebuilt != nullptr){
+        *rebuilt = true;
+    }
+    if (skipped != nullptr){
+        *skipped = table.skipped();
+    }
+    return InventorySnapshot(snap);
+}
\ No newline at end of file
@@ -0,0 +1,243 @@
+#pragma once
+/*
+Column-oriented (struct-of-arrays) inventory table.
+
+Each field lives in its own contiguous array, and product names are stored
+once in a dictionary with rows holding a 32-bit id. Prices are Money units,
+so every aggregate is an integer sum: the loops are plain element-wise
+arithmetic that the compiler turns into SIMD code at -O3 (or -O2
+-ftree-vectorize), and the result is exact and independent of how the sum
+is split across lanes.
+*/
+
+#include "csv_reader.h"
+#include "inventory_ingest.h"
+#include "money.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+inline std::uint64_t magnitude(std::int64_t value){
+    return value < 0 ? 0 - static_cast<std::uint64_t>(value) : static_cast<std::uint64_t>(value);
+}
+
+// Whether no partial sum of quantity * price over rows rows can leave the
+// int64 range, given the largest magnitude in each column.
+inline bool value_sums_fit(std::uint64_t max_quantity, std::uint64_t max_price, std::size_t rows){
+    std::uint64_t row_bound = 0;
+    std::uint64_t bound = 0;
+    return !__builtin_mul_overflow(max_quantity, max_price, &row_bound)
+        && !__builtin_mul_overflow(row_bound, static_cast<std::uint64_t>(rows), &bound)
+        && bound <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max());
+}
+
+// Read-only view of the columns of an inventory, wherever they are stored
+// (an InventoryTable in memory or a mapped snapshot file).
+struct InventoryColumns {
+    const std::uint32_t* name_id = nullptr;
+    const std::int32_t* quantity = nullptr;
+    const std::int64_t* price = nullptr;   // Money units
+    std::size_t rows = 0;
+    std::size_t names = 0;   // dictionary size; every name_id is below it
+    // value_sums_fit() for these columns, worked out once by whoever builds
+    // the view. When false the value aggregates check every row instead.
+    bool sums_fit = false;
+
+    std::int64_t total_quantity() const {
+        const std::int32_t* q = quantity;
+        const std::size_t n = rows;
+        std::int64_t sum = 0;
+        for (std::size_t i = 0; i < n; ++i){
+            sum += q[i];
+        }
+        return sum;
+    }
+
+    Money total_value() const {
+        const std::int32_t* q = quantity;
+        const std::int64_t* p = price;
+        const std::size_t n = rows;
+        if (!sums_fit){
+            // Rare: values near the Money limits; add one by one with checks.
+            Money sum;
+            for (std::size_t i = 0; i < n; ++i){
+                sum += Money::from_units(p[i]) * q[i];
+            }
+            return sum;
+        }
+        std::int64_t sum = 0;
+        for (std::size_t i = 0; i < n; ++i){
+            sum += static_cast<std::int64_t>(q[i]) * p[i];
+        }
+        return Money::from_units(sum);
+    }
+
+    // Value of the rows in each band [edges[k], edges[k + 1]); the result
+    // has edges.size() + 1 entries, the first for prices below edges[0] and
+    // the last for prices at or above edges.back(). edges must be ascending.
+    std::vector<Money> value_by_price_band(const std::vector<Money>& edges) const {
+        if (!std::is_sorted(edges.begin(), edges.end())){
+            throw std::invalid_argument("price band edges must be ascending");
+        }
+        std::vector<Money> bands(edges.size() + 1);
+        if (!sums_fit){
+            // Rare: values near the Money limits; add one by one with checks.
+            for (std::size_t i = 0; i < rows; ++i){
+                const auto band = std::upper_bound(edges.begin(), edges.end(), Money::from_units(price[i])) - edges.begin();
+                bands[static_cast<std::size_t>(band)] += Money::from_units(price[i]) * quantity[i];
+            }
+            return bands;
+        }
+        // One pass over the columns: every band is summed over a block of
+        // rows while the block is still in cache.
+        constexpr std::size_t kBlockRows = 4096;
+        std::vector<std::int64_t> sums(bands.size(), 0);
+        for (std::size_t begin = 0; begin < rows; begin += kBlockRows){
+            const std::size_t end = std::min(rows, begin + kBlockRows);
+            for (std::size_t b = 0; b < bands.size(); ++b){
+                const std::int64_t lo = b == 0 ? std::numeric_limits<std::int64_t>::min() : edges[b - 1].units();
+                const std::int64_t hi = b == edges.size() ? std::numeric_limits<std::int64_t>::max() : edges[b].units();
+                sums[b] += band_value(begin, end, lo, hi, b == edges.size());
+            }
+        }
+        for (std::size_t b = 0; b < bands.size(); ++b){
+            bands[b] = Money::from_units(sums[b]);
+        }
+        return bands;
+    }
+
+    // Total value per dictionary entry, indexed by name id. Throws if a
+    // name id is out of range, which only a damaged snapshot can hold.
+    std::vector<Money> value_by_name() const {
+        std::vector<Money> values(names);
+        for (std::size_t i = 0; i < rows; ++i){
+            if (name_id[i] >= names){
+                throw std::runtime_error("corrupt inventory: name id out of range");
+            }
+            values[name_id[i]] += Money::from_units(price[i]) * quantity[i];
+        }
+        return values;
+    }
+
+private:
+    // Sums quantity * price over rows [begin, end) with lo <= price < hi (or
+    // <= hi when hi_inclusive). Only valid when sums_fit.
+    std::int64_t band_value(std::size_t begin, std::size_t end, std::int64_t lo, std::int64_t hi,
+                            bool hi_inclusive) const {
+        const std::int32_t* q = quantity;
+        const std::int64_t* p = price;
+        // Each row's value is multiplied by a 0/1 mask rather than selected
+        // with a branch, which keeps the loop vectorizable.
+        std::int64_t sum = 0;
+        for (std::size_t i = begin; i < end; ++i){
+            const std::int64_t in_band = static_cast<std::int64_t>(p[i] >= lo)
+                                       & (static_cast<std::int64_t>(p[i] < hi) | static_cast<std::int64_t>(hi_inclusive & (p[i] == hi)));
+            sum += static_cast<std::int64_t>(q[i]) * p[i] * in_band;
+        }
+        return sum;
+    }
+};
+
+class InventoryTable {
+public:
+    InventoryTable() = default;
+    // ids_ holds views into names_; a move keeps the deque's strings in
+    // place, but a copy's views would point into the source.
+    InventoryTable(InventoryTable&&) = default;
+    InventoryTable& operator=(InventoryTable&&) = default;
+    InventoryTable(const InventoryTable&) = delete;
+    InventoryTable& operator=(const InventoryTable&) = delete;
+
+    // Loads name,quantity,price rows from path; malformed rows are counted
+    // and skipped.
+    static InventoryTable load(const std::string& path){
+        CsvReader reader(path);
+        if (!reader.is_open()){
+            throw std::runtime_error("cannot open " + path);
+        }
+        InventoryTable table;
+        CsvRecord record;
+        while (reader.next(record)){
+            int quantity = 0;
+            Money price;
+            if (reader.malformed() || !parse_inventory_record(record, quantity, price)){
+                ++table.skipped_;
+                continue;
+            }
+            table.add(record[0], quantity, price);
+        }
+        return table;
+    }
+
+    void add(std::string_view name, std::int32_t quantity, Money price){
+        name_id_.push_back(intern(name));
+        quantity_.push_back(quantity);
+        price_.push_back(price.units());
+        max_quantity_ = std::max(max_quantity_, magnitude(quantity));
+        max_price_ = std::max(max_price_, magnitude(price.units()));
+    }
+
+    std::size_t size() const { return quantity_.size(); }
+    std::size_t distinct_names() const { return names_.size(); }
+    std::size_t skipped() const { return skipped_; }
+
+    // Row accessors.
+    std::string_view name(std::size_t row) const { return names_[name_id_[row]]; }
+    std::uint32_t name_id(std::size_t row) const { return name_id_[row]; }
+    std::int32_t quantity(std::size_t row) const { return quantity_[row]; }
+    Money price(std::size_t row) const { return Money::from_units(price_[row]); }
+
+    // Dictionary entry for an id returned by name_id.
+    std::string_view dictionary(std::uint32_t id) const { return names_[id]; }
+
+    InventoryColumns columns() const {
+        InventoryColumns view;
+        view.name_id = name_id_.data();
+        view.quantity = quantity_.data();
+        view.price = price_.data();
+        view.rows = quantity_.size();
+        view.names = names_.size();
+        view.sums_fit = value_sums_fit(max_quantity_, max_price_, view.rows);
+        return view;
+    }
+
+    std::int64_t total_quantity() const { return columns().total_quantity(); }
+    Money total_value() const { return columns().total_value(); }
+    std::vector<Money> value_by_price_band(const std::vector<Money>& edges) const {
+        return columns().value_by_price_band(edges);
+    }
+    std::vector<Money> value_by_name() const { return columns().value_by_name(); }
+
+private:
+    std::uint32_t intern(std::string_view name){
+        const auto it = ids_.find(name);
+        if (it != ids_.end()){
+            return it->second;
+        }
+        if (names_.size() > UINT32_MAX){
+            throw std::length_error("too many distinct product names");
+        }
+        const auto id = static_cast<std::uint32_t>(names_.size());
+        // deque keeps existing strings in place, so the string_view keys in
+        // ids_ stay valid as the dictionary grows.
+        names_.emplace_back(name);
+        ids_.emplace(names_.back(), id);
+        return id;
+    }
+
+    std::vector<std::uint32_t> name_id_;
+    std::vector<std::int32_t> quantity_;
+    std::vector<std::int64_t> price_;   // Money units
+    std::deque<std::string> names_;
+    std::unordered_map<std::string_view, std::uint32_t> ids_;
+    std::size_t skipped_ = 0;
+    std::uint64_t max_quantity_ = 0;   // largest magnitudes so far, for value_sums_fit
+    std::uint64_t max_price_ = 0;
+};
\ No newline at end of file
@@ -0,0 +1,130 @@
+#pragma once
+/*
+Top-N most valuable inventory lines (quantity * price) of files of any size.
+
+Each worker scans its own slice of the memory-mapped file into a bounded
+min-heap of its n best lines, whose top is the weakest entry kept; a line
+only costs a comparison unless it beats that entry. The per-worker heaps
+are merged at the end, so memory is O(threads * n) however long the file is.
+
+Ranking is by value, then name, then quantity, which is a total order, so
+the result does not depend on the thread count.
+*/
+
+#include "inventory_ingest.h"
+
+#include <algorithm>
+#include <exception>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+struct TopProduct {
+    std::string name;
+    int quantity = 0;
+    Money value;
+};
+
+class TopProducts {
+public:
+    explicit TopProducts(std::size_t n) : n_(n) {}
+
+    void offer(std::string_view name, int quantity, Money value){
+        if (n_ == 0){
+            return;
+        }
+        if (heap_.size() < n_){
+            heap_.push_back(TopProduct{std::string(name), quantity, value});
+            std::push_heap(heap_.begin(), heap_.end(), ranks_above);
+            return;
+        }
+        if (!outranks(name, quantity, value, heap_.front())){
+            return;
+        }
+        // Replace the weakest entry, reusing its string.
+        std::pop_heap(heap_.begin(), heap_.end(), ranks_above);
+        TopProduct& slot = heap_.back();
+        slot.name.assign(name.data(), name.size());
+        slot.quantity = quantity;
+        slot.value = value;
+        std::push_heap(heap_.begin(), heap_.end(), ranks_above);
+    }
+
+    void merge(const TopProducts& other){
+        for (const TopProduct& product : other.heap_){
+            offer(product.name, product.quantity, product.value);
+        }
+    }
+
+    // The kept lines, most valuable first.
+    std::vector<TopProduct> sorted() const {
+        std::vector<TopProduct> result = heap_;
+        std::sort(result.begin(), result.end(), ranks_above);
+        return result;
+    }
+
+private:
+    static bool outranks(std::string_view name, int quantity, Money value, const TopProduct& other){
+        if (value != other.value){
+            return value > other.value;
+        }
+        if (name != other.name){
+            return name < other.name;
+        }
+        return quantity > other.quantity;
+    }
+    // As a heap comparator this keeps the lowest-ranked line at the front.
+    static bool ranks_above(const TopProduct& a, const TopProduct& b){
+        return outranks(a.name, a.quantity, a.value, b);
+    }
+
+    std::size_t n_;
+    std::vector<TopProduct> heap_;
+};
+
+// The n most valuable lines of path, scanned on up to threads workers (0 =
+// one per core). malformed, if given, receives the number of skipped lines.
+inline std::vector<TopProduct>
+top_products_parallel(const std::string& path, std::size_t n, unsigned threads,
+                      long long* malformed = nullptr){
+    const MappedInventory file(path);
+    if (threads == 0){
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const std::vector<std::size_t> bounds = split_at_newlines(file.data(), file.size(), file.size() / threads + 1);
+    const std::size_t slices = bounds.size() - 1;
+
+    std::vector<TopProducts> heaps(slices, TopProducts(n));
+    std::vector<long long> skipped(slices, 0);
+    std::vector<std::exception_ptr> failures(slices);
+    std::vector<std::thread> workers;
+    for (std::size_t s = 0; s < slices; ++s){
+        workers.emplace_back([&, s]{
+            try {
+                skipped[s] = for_each_inventory_record(file.data() + bounds[s], bounds[s + 1] - bounds[s],
+                    [&](std::string_view name, int quantity, Money price){
+                        heaps[s].offer(name, quantity, price * quantity);
+                    });
+            } catch (...){
+                failures[s] = std::current_exception();
+            }
+        });
+    }
+    for (std::thread& t : workers){
+        t.join();
+    }
+    TopProducts top(n);
+    long long total_skipped = 0;
+    for (std::size_t s = 0; s < slices; ++s){
+        if (failures[s]){
+            std::rethrow_exception(failures[s]);
+        }
+        top.merge(heaps[s]);
+        total_skipped += skipped[s];
+    }
+    if (malformed != nullptr){
+        *malformed = total_skipped;
+    }
+    return top.sorted();
+}
\ No newline at end of file
@@ -0,0 +1,184 @@
+#pragma once
+/*
+Fixed-point currency amounts.
+
+A Money value is a signed 64-bit count of 1/10000 currency units (four
+decimal places, the same scale as SQL Server's MONEY type), which covers
+about +/-922 trillion. Parsing and formatting are exact decimal conversions,
+and arithmetic throws std::overflow_error instead of wrapping. Integer
+addition is associative, so totals come out bit-identical whatever order or
+grouping (threads, SIMD lanes, incremental updates) they are summed in.
+*/
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+class Money {
+public:
+    static constexpr int kDecimals = 4;
+    static constexpr std::int64_t kScale = 10000;
+
+    constexpr Money() = default;
+
+    static constexpr Money from_units(std::int64_t units){
+        Money m;
+        m.units_ = units;
+        return m;
+    }
+    constexpr std::int64_t units() const { return units_; }
+
+    // Parses "[+-]digits[.digits]" with optional surrounding spaces. Digits
+    // past the fourth decimal must be zeros, so nothing is silently rounded.
+    static bool try_parse(std::string_view text, Money& value){
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t')){
+            text.remove_prefix(1);
+        }
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t')){
+            text.remove_suffix(1);
+        }
+        bool negative = false;
+        if (!text.empty() && (text.front() == '-' || text.front() == '+')){
+            negative = text.front() == '-';
+            text.remove_prefix(1);
+        }
+        std::uint64_t units = 0;
+        bool any_digit = false;
+        std::size_t i = 0;
+        for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i){
+            if (units > (kMaxMagnitude - 9) / 10){
+                return false;
+            }
+            units = units * 10 + static_cast<std::uint64_t>(text[i] - '0');
+            any_digit = true;
+        }
+        if (units > kMaxMagnitude / kScale){
+            return false;
+        }
+        units *= kScale;
+        if (i < text.size() && text[i] == '.'){
+            ++i;
+            std::uint64_t place = kScale / 10;
+            for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i){
+                const auto digit = static_cast<std::uint64_t>(text[i] - '0');
+                if (place == 0){
+                    if (digit != 0){
+                        return false;
+                    }
+                } else {
+                    units += digit * place;
+                    place /= 10;
+                }
+                any_digit = true;
+            }
+        }
+        if (!any_digit || i != text.size() || units > kMaxMagnitude){
+            return false;
+        }
+        value.units_ = negative ? -static_cast<std::int64_t>(units) : static_cast<std::int64_t>(units);
+        return true;
+    }
+
+    static Money parse(std::string_view text){
+        Money value;
+        if (!try_parse(text, value)){
+            throw std::invalid_argument("invalid amount: " + std::string(text));
+        }
+        return value;
+    }
+
+    Money& operator+=(Money other){
+        if (__builtin_add_overflow(units_, other.units_, &units_)){
+            throw std::overflow_error("money overflow");
+        }
+        return *this;
+    }
+    Money& operator-=(Money other){
+        if (__builtin_sub_overflow(units_, other.units_, &units_)){
+            throw std::overflow_error("money overflow");
+        }
+        return *this;
+    }
+    Money& operator*=(std::int64_t quantity){
+        if (__builtin_mul_overflow(units_, quantity, &units_)){
+            throw std::overflow_error("money overflow");
+        }
+        return *this;
+    }
+    friend Money operator+(Money a, Money b){ return a += b; }
+    friend Money operator-(Money a, Money b){ return a -= b; }
+    friend Money operator*(Money a, std::int64_t quantity){ return a *= quantity; }
+    friend Money operator*(std::int64_t quantity, Money a){ return a *= quantity; }
+
+    friend constexpr bool operator==(Money a, Money b){ return a.units_ == b.units_; }
+    friend constexpr bool operator!=(Money a, Money b){ return a.units_ != b.units_; }
+    friend constexpr bool operator<(Money a, Money b){ return a.units_ < b.units_; }
+    friend constexpr bool operator<=(Money a, Money b){ return a.units_ <= b.units_; }
+    friend constexpr bool operator>(Money a, Money b){ return a.units_ > b.units_; }
+    friend constexpr bool operator>=(Money a, Money b){ return a.units_ >= b.units_; }
+
+    // Nearest double, for display or statistics only.
+    double to_double() const { return static_cast<double>(units_) / kScale; }
+
+private:
+    // Largest magnitude both signs can hold, so negation never overflows.
+    static constexpr std::uint64_t kMaxMagnitude = static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max());
+
+    std::int64_t units_ = 0;
+};
+
+// Appends value with decimals (0-4) places, rounding half to even like
+// std::fixed does for an exact tie, e.g. 1000.00 for 999.999 at 2 places.
+inline void append_money(std::string& out, Money value, int decimals = 2){
+    if (decimals < 0 || decimals > Money::kDecimals){
+        throw std::invalid_argument("money supports 0 to 4 decimals");
+    }
+    std::int64_t drop = 1;
+    for (int d = decimals; d < Money::kDecimals; ++d){
+        drop *= 10;
+    }
+    const bool negative = value.units() < 0;
+    // Work on the magnitude as unsigned so INT64_MIN is not a special case.
+    std::uint64_t magnitude = negative ? 0 - static_cast<std::uint64_t>(value.units())
+                                       : static_cast<std::uint64_t>(value.units());
+    std::uint64_t kept = magnitude / static_cast<std::uint64_t>(drop);
+    const std::uint64_t rest = magnitude % static_cast<std::uint64_t>(drop);
+    const std::uint64_t half = static_cast<std::uint64_t>(drop) / 2;
+    if (drop > 1 && (rest > half || (rest == half && (kept & 1) != 0))){
+        ++kept;
+    }
+    std::uint64_t scale = 1;
+    for (int d = 0; d < decimals; ++d){
+        scale *= 10;
+    }
+    const std::uint64_t whole = kept / scale;
+    const std::uint64_t fraction = kept % scale;
+
+    char digits[32];
+    char* p = digits + sizeof digits;
+    if (decimals > 0){
+        std::uint64_t f = fraction;
+        for (int d = 0; d < decimals; ++d){
+            *--p = static_cast<char>('0' + f % 10);
+            f /= 10;
+        }
+        *--p = '.';
+    }
+    std::uint64_t w = whole;
+    do {
+        *--p = static_cast<char>('0' + w % 10);
+        w /= 10;
+    } while (w != 0);
+    if (negative){
+        *--p = '-';   // "-0.00" for small negatives, as printf gives
+    }
+    out.append(p, static_cast<std::size_t>(digits + sizeof digits - p));
+}
+
+inline std::string to_string(Money value, int decimals = 2){
+    std::string out;
+    append_money(out, value, decimals);
+    return out;
+}
\ No newline at end of file
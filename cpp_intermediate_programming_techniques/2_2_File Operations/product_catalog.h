@@ -0,0 +1,208 @@
+#pragma once
+/*
+Read-only index over a list of product names (one per line, as in
+products.txt), for repeated exact and prefix lookups.
+
+Everything lives in one contiguous arena:
+
+    slots    uint64[capacity]   open-addressing hash table (linear probing);
+                                each slot is (hash tag << 32) | (index + 1),
+                                0 when empty
+    offsets  uint32[count + 1]  start of each name in the character block
+    chars    names, sorted and deduplicated, back to back
+
+Exact lookups hash the name and compare strings only when the stored 32-bit
+tag matches. Because the names are sorted, the products starting with a
+prefix form one contiguous run of indices, found with two binary searches.
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Indices [first, last) of a run of names in a ProductCatalog.
+struct ProductRange {
+    std::size_t first = 0;
+    std::size_t last = 0;
+
+    std::size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+};
+
+class ProductCatalog {
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    // Loads one name per line from path; blank lines are ignored and a
+    // trailing '\r' is dropped.
+    static ProductCatalog from_file(const std::string& path){
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()){
+            throw std::runtime_error("cannot open " + path);
+        }
+        const std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::vector<std::string_view> names;
+        std::size_t pos = 0;
+        while (pos < text.size()){
+            std::size_t end = text.find('\n', pos);
+            if (end == std::string::npos){
+                end = text.size();
+            }
+            std::string_view line(text.data() + pos, end - pos);
+            if (!line.empty() && line.back() == '\r'){
+                line.remove_suffix(1);
+            }
+            if (!line.empty()){
+                names.push_back(line);
+            }
+            pos = end + 1;
+        }
+        return ProductCatalog(std::move(names));
+    }
+
+    // Builds the index; the names are copied, so the views may dangle later.
+    explicit ProductCatalog(std::vector<std::string_view> names){
+        std::sort(names.begin(), names.end());
+        names.erase(std::unique(names.begin(), names.end()), names.end());
+        count_ = names.size();
+
+        std::size_t chars = 0;
+        for (std::string_view name : names){
+            chars += name.size();
+        }
+        if (chars > UINT32_MAX || count_ >= UINT32_MAX){
+            throw std::length_error("product catalog too large");
+        }
+        // Load factor at most 1/2 keeps probe sequences short.
+        capacity_ = 16;
+        while (capacity_ < count_ * 2){
+            capacity_ *= 2;
+        }
+
+        const std::size_t slot_bytes = capacity_ * sizeof(std::uint64_t);
+        const std::size_t offset_bytes = (count_ + 1) * sizeof(std::uint32_t);
+        arena_.assign((slot_bytes + offset_bytes + chars + 7) / 8, 0);
+        char* base = reinterpret_cast<char*>(arena_.data());
+        slots_ = reinterpret_cast<std::uint64_t*>(base);
+        offsets_ = reinterpret_cast<std::uint32_t*>(base + slot_bytes);
+        chars_ = base + slot_bytes + offset_bytes;
+
+        std::uint32_t at = 0;
+        for (std::size_t i = 0; i < count_; ++i){
+            offsets_[i] = at;
+            std::memcpy(chars_ + at, names[i].data(), names[i].size());
+            at += static_cast<std::uint32_t>(names[i].size());
+
+            const std::uint64_t h = hash(names[i]);
+            std::size_t slot = static_cast<std::size_t>(h) & (capacity_ - 1);
+            while (slots_[slot] != 0){
+                slot = (slot + 1) & (capacity_ - 1);
+            }
+            slots_[slot] = (h >> 32 << 32) | (i + 1);
+        }
+        offsets_[count_] = at;
+    }
+
+    // The arena holds raw pointers into itself, so copies would alias it.
+    ProductCatalog(ProductCatalog&&) = default;
+    ProductCatalog& operator=(ProductCatalog&&) = default;
+    ProductCatalog(const ProductCatalog&) = delete;
+    ProductCatalog& operator=(const ProductCatalog&) = delete;
+
+    std::size_t size() const { return count_; }
+
+    // Name at index i of the sorted order.
+    std::string_view name(std::size_t i) const {
+        return std::string_view(chars_ + offsets_[i], offsets_[i + 1] - offsets_[i]);
+    }
+
+    // Sorted index of product, or npos.
+    std::size_t find(std::string_view product) const {
+        if (count_ == 0){
+            return npos;
+        }
+        const std::uint64_t h = hash(product);
+        const std::uint64_t tag = h >> 32 << 32;
+        std::size_t slot = static_cast<std::size_t>(h) & (capacity_ - 1);
+        while (slots_[slot] != 0){
+            const std::uint64_t entry = slots_[slot];
+            if ((entry & 0xFFFFFFFF00000000ull) == tag){
+                const std::size_t i = static_cast<std::size_t>(entry & 0xFFFFFFFFull) - 1;
+                if (name(i) == product){
+                    return i;
+                }
+            }
+            slot = (slot + 1) & (capacity_ - 1);
+        }
+        return npos;
+    }
+
+    bool contains(std::string_view product) const { return find(product) != npos; }
+
+    // All products whose name starts with prefix, in sorted order.
+    ProductRange with_prefix(std::string_view prefix) const {
+        ProductRange range;
+        range.first = lower_bound(prefix);
+        std::size_t lo = range.first;
+        std::size_t hi = count_;
+        // Names sharing the prefix are contiguous from range.first; find
+        // the first one that no longer starts with it.
+        while (lo < hi){
+            const std::size_t mid = lo + (hi - lo) / 2;
+            if (name(mid).substr(0, prefix.size()) == prefix){
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        range.last = lo;
+        return range;
+    }
+
+    // Bytes used by the index, all in one allocation.
+    std::size_t memory_bytes() const { return arena_.size() * sizeof(std::uint64_t); }
+
+private:
+    static std::uint64_t hash(std::string_view s){
+        // FNV-1a with a final avalanche so both halves are usable: the low
+        // bits pick the slot and the high 32 bits are the tag.
+        std::uint64_t h = 14695981039346656037ull;
+        for (unsigned char c : s){
+            h ^= c;
+            h *= 1099511628211ull;
+        }
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // First sorted index whose name is not less than key.
+    std::size_t lower_bound(std::string_view key) const {
+        std::size_t lo = 0;
+        std::size_t hi = count_;
+        while (lo < hi){
+            const std::size_t mid = lo + (hi - lo) / 2;
+            if (name(mid) < key){
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    std::vector<std::uint64_t> arena_;
+    std::uint64_t* slots_ = nullptr;
+    std::uint32_t* offsets_ = nullptr;
+    char* chars_ = nullptr;
+    std::size_t count_ = 0;
+    std::size_t capacity_ = 0;
+};
\ No newline at end of file
@@ -0,0 +1,65 @@
+/*
+Index products.txt once, then answer lookups read from standard input, one
+per line:
+
+    exists Wireless Mouse     does this exact product exist?
+    prefix Key                every product whose name starts with "Key"
+
+Usage: product_lookup [FILE]   (default products.txt)
+*/
+
+#include <chrono>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "product_catalog.h"
+
+int main(int argc, char* argv[]) {
+    const std::string inputFile = argc > 1 ? argv[1] : "products.txt";
+    std::optional<ProductCatalog> index;
+    try {
+        index.emplace(ProductCatalog::from_file(inputFile));
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    const ProductCatalog& catalog = *index;
+    std::cout << "Indexed " << catalog.size() << " products (" << catalog.memory_bytes()
+              << " bytes)" << std::endl;
+
+    long long queries = 0;
+    std::chrono::duration<double> busy{};
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        const std::string_view text(line);
+        const std::size_t space = text.find(' ');
+        const std::string_view command = text.substr(0, space);
+        const std::string_view argument = space == std::string_view::npos ? std::string_view() : text.substr(space + 1);
+        if (command.empty()) {
+            continue;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        if (command == "exists") {
+            std::cout << (catalog.contains(argument) ? "yes" : "no") << '\n';
+        } else if (command == "prefix") {
+            const ProductRange range = catalog.with_prefix(argument);
+            for (std::size_t i = range.first; i < range.last; ++i) {
+                std::cout << catalog.name(i) << '\n';
+            }
+            std::cout << range.size() << " match(es)" << '\n';
+        } else {
+            std::cerr << "Unknown query: " << command << std::endl;
+            continue;
+        }
+        busy += std::chrono::steady_clock::now() - start;
+        ++queries;
+    }
+    std::cout.flush();
+    if (queries > 0) {
+        std::cerr << queries << " queries in " << busy.count() << " s ("
+                  << static_cast<long long>(queries / (busy.count() > 0 ? busy.count() : 1e-9))
+                  << " queries/s)" << std::endl;
+    }
+    return 0;
+}
\ No newline at end of file
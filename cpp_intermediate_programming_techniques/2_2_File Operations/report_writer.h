@@ -0,0 +1,179 @@
+#pragma once
+/*
+Buffered writer for text reports.
+
+Rows are formatted straight into one large reusable buffer and written to the
+file in big blocks, instead of going through iostream manipulators and an
+std::endl flush per line. Numbers are formatted with std::to_chars, and
+column widths are fixed up front in ColumnSpec values. The output is
+byte-for-byte what the equivalent iostream code produces:
+
+    out << std::left << std::setw(15) << name       append_cell(buf, {15, Align::Left}, name)
+    out << std::fixed << std::setprecision(2) << x  append_fixed(buf, x, 2)
+
+The append_* functions also work on any std::string, e.g. to build a block
+of report text on a worker thread.
+*/
+
+#include "money.h"
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+enum class Align { Left, Right };
+
+// One column of a report: text shorter than width is padded with spaces on
+// the side opposite to the alignment, like std::setw; longer text is kept
+// whole. A width of 0 means no padding.
+struct ColumnSpec {
+    std::size_t width = 0;
+    Align align = Align::Left;
+};
+
+inline void append_integer(std::string& out, long long value){
+    char digits[24];
+    const auto result = std::to_chars(digits, digits + sizeof digits, value);
+    out.append(digits, static_cast<std::size_t>(result.ptr - digits));
+}
+
+// Same digits as std::fixed << std::setprecision(precision).
+inline void append_fixed(std::string& out, double value, int precision){
+    char digits[352];   // enough for any double in fixed notation
+    const auto result = std::to_chars(digits, digits + sizeof digits, value, std::chars_format::fixed, precision);
+    if (result.ec != std::errc()){
+        throw std::runtime_error("number too long to format");
+    }
+    out.append(digits, static_cast<std::size_t>(result.ptr - digits));
+}
+
+inline void append_cell(std::string& out, const ColumnSpec& column, std::string_view text){
+    const std::size_t pad = text.size() < column.width ? column.width - text.size() : 0;
+    if (column.align == Align::Right){
+        out.append(pad, ' ');
+    }
+    out.append(text.data(), text.size());
+    if (column.align == Align::Left){
+        out.append(pad, ' ');
+    }
+}
+
+inline void append_cell(std::string& out, const ColumnSpec& column, long long value){
+    char digits[24];
+    const auto result = std::to_chars(digits, digits + sizeof digits, value);
+    append_cell(out, column, std::string_view(digits, static_cast<std::size_t>(result.ptr - digits)));
+}
+
+// Writes a report file through a large buffer that is flushed only when
+// full, by flush(), or on destruction.
+class ReportWriter {
+public:
+    explicit ReportWriter(const std::string& path, bool append = false,
+                          std::size_t block_size = std::size_t{1} << 20)
+        : block_size_(block_size) {
+        // The stream's own buffer would only add a copy; blocks go straight
+        // to the file.
+        file_.rdbuf()->pubsetbuf(nullptr, 0);
+        file_.open(path, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+        buffer_.reserve(block_size_ + 1024);
+    }
+    ~ReportWriter(){
+        try {
+            flush();
+        } catch (...){
+            // Call flush() or close() explicitly to see write errors.
+        }
+    }
+    ReportWriter(const ReportWriter&) = delete;
+    ReportWriter& operator=(const ReportWriter&) = delete;
+
+    bool is_open() const { return file_.is_open(); }
+
+    ReportWriter& text(std::string_view s){
+        if (s.size() >= block_size_){
+            // Already a whole block: write it without copying it first.
+            flush();
+            write_block(s.data(), s.size());
+            return *this;
+        }
+        buffer_.append(s.data(), s.size());
+        return maybe_flush();
+    }
+    ReportWriter& integer(long long value){
+        append_integer(buffer_, value);
+        return maybe_flush();
+    }
+    ReportWriter& fixed(double value, int precision){
+        append_fixed(buffer_, value, precision);
+        return maybe_flush();
+    }
+    ReportWriter& money(Money value, int decimals = 2){
+        append_money(buffer_, value, decimals);
+        return maybe_flush();
+    }
+    ReportWriter& cell(const ColumnSpec& column, std::string_view s){
+        append_cell(buffer_, column, s);
+        return maybe_flush();
+    }
+    ReportWriter& cell(const ColumnSpec& column, long long value){
+        append_cell(buffer_, column, value);
+        return maybe_flush();
+    }
+    ReportWriter& newline(){
+        buffer_ += '\n';
+        return maybe_flush();
+    }
+
+    // Calls format(std::string&) to append to the buffer, for rows built with
+    // the append_* functions.
+    template <class Format>
+    ReportWriter& append(Format&& format){
+        format(buffer_);
+        return maybe_flush();
+    }
+
+    // Bytes handed to this writer so far, flushed or not.
+    std::uint64_t bytes_written() const { return flushed_ + buffer_.size(); }
+
+    void flush(){
+        if (buffer_.empty()){
+            return;
+        }
+        write_block(buffer_.data(), buffer_.size());
+        buffer_.clear();   // keeps the capacity for the next block
+    }
+
+    void close(){
+        flush();
+        file_.close();
+        if (!file_){
+            throw std::runtime_error("error closing report");
+        }
+    }
+
+private:
+    void write_block(const char* data, std::size_t size){
+        file_.write(data, static_cast<std::streamsize>(size));
+        if (!file_){
+            throw std::runtime_error("error writing report");
+        }
+        flushed_ += size;
+    }
+
+    ReportWriter& maybe_flush(){
+        if (buffer_.size() >= block_size_){
+            flush();
+        }
+        return *this;
+    }
+
+    std::ofstream file_;
+    std::string buffer_;
+    std::size_t block_size_;
+    std::uint64_t flushed_ = 0;
+};
\ No newline at end of file
@@ -0,0 +1,286 @@
+#pragma once
+/*
+GROUP BY aggregation for sales logs, with a bounded memory budget.
+
+Groups are summed in an in-memory hash table keyed by the group key (e.g.
+the product name, or date and product). When the table's estimated size
+passes the budget, its partial sums are spilled to partition files on disk,
+chosen by a hash of the key, and the table starts over. A key can then end
+up partially summed in several spills, but always in the same partition.
+
+finish() sums each partition on its own with a fresh aggregator, which
+spills again, one level deeper and with a different hash, if a partition
+is still too large. Each partition result is written sorted by key, and the
+sorted runs are merged, so the output is in key order whether or not
+anything was spilled.
+*/
+
+#include "money.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+constexpr std::size_t kDefaultSalesBudget = std::size_t{256} << 20;
+
+struct SalesTotals {
+    long long quantity = 0;
+    Money revenue;
+    long long orders = 0;
+
+    SalesTotals& operator+=(const SalesTotals& other){
+        quantity += other.quantity;
+        revenue += other.revenue;
+        orders += other.orders;
+        return *this;
+    }
+};
+
+// Spill and run files hold (length, key, totals) records in native byte
+// order; they never outlive the aggregator that wrote them.
+inline void write_sales_group(std::ostream& out, std::string_view key, const SalesTotals& totals){
+    const auto length = static_cast<std::uint32_t>(key.size());
+    const std::int64_t fields[3] = {totals.quantity, totals.revenue.units(), totals.orders};
+    out.write(reinterpret_cast<const char*>(&length), sizeof length);
+    out.write(key.data(), static_cast<std::streamsize>(key.size()));
+    out.write(reinterpret_cast<const char*>(fields), sizeof fields);
+}
+
+inline bool read_sales_group(std::istream& in, std::string& key, SalesTotals& totals){
+    std::uint32_t length = 0;
+    if (!in.read(reinterpret_cast<char*>(&length), sizeof length)){
+        return false;
+    }
+    std::int64_t fields[3];
+    key.resize(length);
+    if (!in.read(key.data(), length) || !in.read(reinterpret_cast<char*>(fields), sizeof fields)){
+        throw std::runtime_error("truncated sales spill file");
+    }
+    totals.quantity = fields[0];
+    totals.revenue = Money::from_units(fields[1]);
+    totals.orders = fields[2];
+    return true;
+}
+
+class SalesAggregator {
+public:
+    using Emit = std::function<void(std::string_view key, const SalesTotals& totals)>;
+
+    static constexpr std::size_t kPartitions = 16;
+    static constexpr unsigned kMaxDepth = 8;
+
+    explicit SalesAggregator(std::size_t memory_budget = kDefaultSalesBudget,
+                             std::filesystem::path spill_dir = std::filesystem::temp_directory_path(),
+                             unsigned depth = 0)
+        : budget_(memory_budget), spill_dir_(std::move(spill_dir)), depth_(depth) {}
+
+    SalesAggregator(const SalesAggregator&) = delete;
+    SalesAggregator& operator=(const SalesAggregator&) = delete;
+
+    ~SalesAggregator(){
+        remove_files();
+    }
+
+    void add(std::string_view key, const SalesTotals& totals){
+        auto it = groups_.find(key);
+        if (it == groups_.end()){
+            // deque keeps existing strings in place, so the string_view keys
+            // in groups_ stay valid as more keys arrive.
+            keys_.emplace_back(key);
+            it = groups_.emplace(keys_.back(), SalesTotals()).first;
+            used_ += key.size() + kGroupOverhead;
+        }
+        it->second += totals;
+        // A single group is never spilled on its own, so every spill makes
+        // progress however small the budget.
+        if (used_ > budget_ && groups_.size() > 1){
+            spill();
+        }
+    }
+
+    void add(std::string_view key, long long quantity, Money revenue){
+        SalesTotals totals;
+        totals.quantity = quantity;
+        totals.revenue = revenue;
+        totals.orders = 1;
+        add(key, totals);
+    }
+
+    // Emits every group once, in key order, and leaves the aggregator empty.
+    void finish(const Emit& emit){
+        if (partitions_.empty()){
+            emit_sorted(emit);
+            return;
+        }
+        spill();
+        for (std::ofstream& out : partitions_){
+            out.close();
+            if (!out){
+                throw std::runtime_error("error writing sales spill file");
+            }
+        }
+        // Sum each partition into its own sorted run...
+        std::string key;
+        SalesTotals totals;
+        for (std::size_t p = 0; p < kPartitions; ++p){
+            SalesAggregator partition(budget_, spill_dir_, depth_ + 1);
+            {
+                std::ifstream in(spill_paths_[p], std::ios::binary);
+                while (read_sales_group(in, key, totals)){
+                    partition.add(key, totals);
+                }
+            }
+            std::filesystem::remove(spill_paths_[p]);
+            run_paths_.push_back(file_path("run", p));
+            std::ofstream out(run_paths_.back(), std::ios::binary | std::ios::trunc);
+            partition.finish([&](std::string_view k, const SalesTotals& t){
+                write_sales_group(out, k, t);
+            });
+            out.close();
+            if (!out){
+                throw std::runtime_error("error writing sales run file");
+            }
+            spills_ += partition.spill_count();
+        }
+        // ...then merge the runs. Partitions hold disjoint keys, so this only
+        // interleaves them.
+        merge_runs(run_paths_, emit);
+        remove_files();
+    }
+
+    // Spills so far, including those of the partition aggregators finish()
+    // used, so it is complete once finish() has returned.
+    std::uint64_t spill_count() const { return spills_; }
+
+private:
+    // Rough heap cost of one group besides its key: hash node, bucket and
+    // the deque's std::string.
+    static constexpr std::size_t kGroupOverhead = 96;
+
+    std::size_t partition_of(std::string_view key) const {
+        // A different mix per depth, so a partition that is spilled again
+        // splits instead of landing in one sub-partition.
+        std::uint64_t h = std::hash<std::string_view>{}(key);
+        h ^= (depth_ + 1) * 0x9E3779B97F4A7C15ull;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        return static_cast<std::size_t>(h % kPartitions);
+    }
+
+    std::filesystem::path file_path(const char* kind, std::size_t p) const {
+        return spill_dir_ / ("sales_" + std::string(kind) + "_" + std::to_string(::getpid()) + "_" +
+                             std::to_string(id_) + "_" + std::to_string(p) + ".bin");
+    }
+
+    void spill(){
+        if (depth_ >= kMaxDepth){
+            throw std::length_error("sales groups do not fit the memory budget");
+        }
+        if (partitions_.empty()){
+            for (std::size_t p = 0; p < kPartitions; ++p){
+                spill_paths_.push_back(file_path("spill", p));
+                partitions_.emplace_back(spill_paths_.back(), std::ios::binary | std::ios::trunc);
+                if (!partitions_.back().is_open()){
+                    throw std::runtime_error("cannot create " + spill_paths_.back().string());
+                }
+            }
+        }
+        for (const auto& [key, totals] : groups_){
+            write_sales_group(partitions_[partition_of(key)], key, totals);
+        }
+        groups_.clear();
+        keys_.clear();
+        used_ = 0;
+        ++spills_;
+    }
+
+    void emit_sorted(const Emit& emit){
+        std::vector<const std::pair<const std::string_view, SalesTotals>*> order;
+        order.reserve(groups_.size());
+        for (const auto& group : groups_){
+            order.push_back(&group);
+        }
+        std::sort(order.begin(), order.end(), [](const auto* a, const auto* b){
+            return a->first < b->first;
+        });
+        for (const auto* group : order){
+            emit(group->first, group->second);
+        }
+        groups_.clear();
+        keys_.clear();
+        used_ = 0;
+    }
+
+    static void merge_runs(const std::vector<std::filesystem::path>& runs, const Emit& emit){
+        struct Head {
+            std::string key;
+            SalesTotals totals;
+            std::size_t run;
+        };
+        std::vector<std::unique_ptr<std::ifstream>> inputs;
+        auto later = [](const Head& a, const Head& b){ return a.key > b.key; };
+        std::priority_queue<Head, std::vector<Head>, decltype(later)> heads(later);
+        for (std::size_t r = 0; r < runs.size(); ++r){
+            inputs.push_back(std::make_unique<std::ifstream>(runs[r], std::ios::binary));
+            Head head;
+            head.run = r;
+            if (read_sales_group(*inputs[r], head.key, head.totals)){
+                heads.push(std::move(head));
+            }
+        }
+        while (!heads.empty()){
+            Head head = heads.top();
+            heads.pop();
+            emit(head.key, head.totals);
+            if (read_sales_group(*inputs[head.run], head.key, head.totals)){
+                heads.push(std::move(head));
+            }
+        }
+    }
+
+    void remove_files(){
+        partitions_.clear();
+        std::error_code ec;
+        for (const auto& path : spill_paths_){
+            std::filesystem::remove(path, ec);
+        }
+        for (const auto& path : run_paths_){
+            std::filesystem::remove(path, ec);
+        }
+        spill_paths_.clear();
+        run_paths_.clear();
+    }
+
+    static std::uint64_t next_id(){
+        static std::atomic<std::uint64_t> counter{0};
+        return counter++;
+    }
+
+    std::size_t budget_;
+    std::filesystem::path spill_dir_;
+    unsigned depth_;
+    std::uint64_t id_ = next_id();   // keeps file names unique per aggregator
+    std::deque<std::string> keys_;
+    std::unordered_map<std::string_view, SalesTotals> groups_;
+    std::size_t used_ = 0;
+    std::uint64_t spills_ = 0;
+    std::vector<std::ofstream> partitions_;
+    std::vector<std::filesystem::path> spill_paths_;
+    std::vector<std::filesystem::path> run_paths_;
+};
\ No newline at end of file
@@ -0,0 +1,159 @@
+/*
+Summarise a sales log into a grouped sales report: total quantity, number of
+orders and revenue per product, or per day and product.
+
+Each line of the log is one sale:
+
+    2024-05-01,Laptop,5,999.999      date,product,quantity,unit price
+
+Usage: sales_summary [--by-date] [--memory MB] [FILE]   (default sales.csv)
+  --by-date     group by date and product instead of product only
+  --memory MB   memory for the group table before it spills to disk
+                (at least 1, default 256)
+
+The report is written to grouped_sales_report.txt, sorted by group.
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include "csv_reader.h"
+#include "money.h"
+#include "report_writer.h"
+#include "sales_aggregate.h"
+
+const ColumnSpec kDateColumn{12, Align::Left};
+const ColumnSpec kProductColumn{20, Align::Left};
+const ColumnSpec kQuantityColumn{10, Align::Left};
+const ColumnSpec kOrdersColumn{10, Align::Left};
+
+// Separates date and product in a --by-date key; sorts before any printable
+// character, so groups order by date, then product.
+constexpr char kKeySeparator = '\0';
+
+int main(int argc, char* argv[]) {
+    std::string inputFile = "sales.csv";
+    const std::string outputFile = "grouped_sales_report.txt";
+    bool byDate = false;
+    std::size_t budget = kDefaultSalesBudget;
+    auto usage = [&]() {
+        std::cerr << "Usage: " << argv[0] << " [--by-date] [--memory MB] [FILE]" << std::endl;
+        return 1;
+    };
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--by-date") {
+            byDate = true;
+        } else if (arg == "--memory" && i + 1 < argc) {
+            std::size_t megabytes = 0;
+            if (!parse_number(argv[++i], megabytes) || megabytes == 0 || megabytes > (SIZE_MAX >> 20)) {
+                return usage();
+            }
+            budget = megabytes << 20;
+        } else if (arg[0] != '-') {
+            inputFile = arg;
+        } else {
+            return usage();
+        }
+    }
+    if (!std::filesystem::exists(inputFile)) {
+        std::cout << "Creating sample sales log..." << std::endl;
+        std::ofstream createFile(inputFile);
+        createFile << "2024-05-01,Laptop,5,999.999" << std::endl;
+        createFile << "2024-05-01,Mouse,12,29.999" << std::endl;
+        createFile << "2024-05-02,Laptop,2,999.999" << std::endl;
+        createFile << "2024-05-02,Mouse,3,29.999" << std::endl;
+        createFile.close();
+    }
+    CsvReader reader(inputFile);
+    if (!reader.is_open()) {
+        std::cerr << "Error opening sales log" << std::endl;
+        return 1;
+    }
+    ReportWriter reportFile(outputFile);
+    if (!reportFile.is_open()) {
+        std::cerr << "Error creating grouped sales report" << std::endl;
+        return 1;
+    }
+    long long rows = 0;
+    long long skipped = 0;
+    long long groups = 0;
+    std::uint64_t spills = 0;
+    std::chrono::duration<double> elapsed{};
+    try {
+        const auto start = std::chrono::steady_clock::now();
+        SalesAggregator aggregator(budget);
+        CsvRecord record;
+        std::string key;
+        while (reader.next(record)) {
+            int quantity = 0;
+            Money price;
+            if (reader.malformed() || record.size() < 4 || !parse_number(record[2], quantity) ||
+                !Money::try_parse(record[3], price)) {
+                ++skipped;
+                continue;
+            }
+            const std::string_view product = trim_spaces(record[1]);
+            if (byDate) {
+                key.assign(trim_spaces(record[0]));
+                key += kKeySeparator;
+                key.append(product.data(), product.size());
+                aggregator.add(key, quantity, price * quantity);
+            } else {
+                aggregator.add(product, quantity, price * quantity);
+            }
+            ++rows;
+        }
+
+        reportFile.text("GROUPED SALES REPORT").newline();
+        reportFile.text("====================").newline();
+        if (byDate) {
+            reportFile.cell(kDateColumn, "Date");
+        }
+        reportFile.cell(kProductColumn, "Product")
+                  .cell(kQuantityColumn, "Quantity")
+                  .cell(kOrdersColumn, "Orders")
+                  .text("Revenue").newline();
+        SalesTotals total;
+        aggregator.finish([&](std::string_view group, const SalesTotals& totals) {
+            std::string_view product = group;
+            if (byDate) {
+                const std::size_t split = group.find(kKeySeparator);
+                reportFile.cell(kDateColumn, group.substr(0, split));
+                product = group.substr(split + 1);
+            }
+            reportFile.cell(kProductColumn, product)
+                      .cell(kQuantityColumn, totals.quantity)
+                      .cell(kOrdersColumn, totals.orders)
+                      .text("$").money(totals.revenue).newline();
+            total += totals;
+            ++groups;
+        });
+        spills = aggregator.spill_count();
+        reportFile.newline();
+        reportFile.text("Total Quantity: ").integer(total.quantity).newline();
+        reportFile.text("Total Revenue: $").money(total.revenue).newline();
+        reportFile.close();
+        elapsed = std::chrono::steady_clock::now() - start;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    if (skipped > 0) {
+        std::cerr << "Skipped " << skipped << " malformed lines" << std::endl;
+    }
+    std::cout << "Grouped sales report generated!" << std::endl;
+    std::cout << "Check " << outputFile << " for results." << std::endl;
+    std::cout << "Aggregated " << rows << " sales into " << groups << " groups in " << std::fixed
+              << std::setprecision(3) << elapsed.count() << " s";
+    if (spills > 0) {
+        std::cout << " (" << spills << " spills to disk)";
+    }
+    std::cout << std::endl;
+    return 0;
+}
\ No newline at end of file
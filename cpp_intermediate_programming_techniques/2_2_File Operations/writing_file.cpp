@@ -10,30 +10,41 @@ Modify the code to append new entries to an existing report using std::ios::app.
 */
 
 #include <iostream>
-#include <fstream>
 #include <string>
-#include <iomanip>
+#include "money.h"
+#include "report_writer.h"
+
+// Column layout of the report, fixed once instead of per row with setw
+const ColumnSpec kProductColumn{15, Align::Left};
+const ColumnSpec kQuantityColumn{10, Align::Left};
+const ColumnSpec kPriceColumn{10, Align::Left};
 
 int main(){
-    std::ofstream reportFile("sales_report.txt");
-    if (!reportFile){
+    ReportWriter reportFile("sales_report.txt");
+    if (!reportFile.is_open()){
         std::cerr << "Error: Could not create sales report.";
         return 1;
     }
-    // Write report header
-    reportFile << "DAILY SALES REPORT" << std::endl;
-    reportFile << "==================" << std::endl;
-    reportFile << std::left << std::setw(15) << "Product"
-               << std::setw(10) << "Quality"
-               << std::setw(10) << "Price" << std::endl;
-    //Sample sales data
-    reportFile << std::left << std::setw(15) << "Laptop"
-               << std::setw(10) << "5"
-               << "$" << std::fixed << std::setprecision(2) << 999.999 << std::endl;
-    reportFile << std::left << std::setw(15) << "Mouse"
-               << std::setw(10) << "12"
-               << "$" << std::fixed << std::setprecision(2) << 29.999 << std::endl;
-    reportFile.close();
+    try {
+        // Write report header
+        reportFile.text("DAILY SALES REPORT").newline();
+        reportFile.text("==================").newline();
+        reportFile.cell(kProductColumn, "Product")
+                  .cell(kQuantityColumn, "Quality")
+                  .cell(kPriceColumn, "Price").newline();
+        //Sample sales data
+        reportFile.cell(kProductColumn, "Laptop")
+                  .cell(kQuantityColumn, 5)
+                  .text("$").money(Money::parse("999.999")).newline();
+        reportFile.cell(kProductColumn, "Mouse")
+                  .cell(kQuantityColumn, 12)
+                  .text("$").money(Money::parse("29.999")).newline();
+        // Rows are buffered; close() writes them out in one block
+        reportFile.close();
+    } catch (const std::exception& e){
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
     std::cout << "Sales report generated successfully!" << std::endl;
     return 0;
 }
@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include "frequency.h"
+#include "utf8.h"
+#include "word.h"
+
+// Every heap allocation in the process goes through these, so a benchmark
+// can report how many allocations one call of an entry point makes.
+static std::atomic<std::uint64_t> g_allocations{0};
+
+void* operator new(std::size_t size){
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)){
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+struct Corpus {
+    std::string name;
+    std::string text;
+};
+
+std::string make_corpus(const std::string& kind, std::size_t size, std::mt19937_64& rng){
+    static const std::vector<std::string> prose = {
+        "the", "of", "and", "to", "in", "is", "that", "for", "it", "as", "was",
+        "with", "be", "by", "on", "not", "he", "this", "are", "or", "his",
+        "from", "at", "which", "but", "have", "an", "had", "they", "you",
+        "were", "their", "one", "all", "we", "can", "her", "has", "there",
+        "been", "if", "more", "when", "will", "would", "who", "so", "no",
+        "performance", "counter", "memory", "bandwidth", "2026", "42"};
+    static const std::vector<std::string> utf8_words = {
+        "straße", "größe", "naïve", "café", "привет", "мир", "日本語", "テキスト",
+        "δέλτα", "αβγ", "١٢٣", "中文", "😀", "İstanbul", "Ærø", "hello"};
+    static const std::string punctuation = ".,;:!?-()[]{}\"'/\\@#$%^&*+=<>|~`";
+
+    std::string out;
+    out.reserve(size + 64);
+    while (out.size() < size){
+        if (kind == "ascii-prose"){
+            out += prose[rng() % prose.size()];
+            out += (rng() % 12 == 0) ? ". " : (rng() % 8 == 0 ? ", " : " ");
+            if (rng() % 80 == 0){
+                out += '\n';
+            }
+        } else if (kind == "punctuation"){
+            out += punctuation[rng() % punctuation.size()];
+            if (rng() % 3 == 0){
+                out += static_cast<char>('a' + rng() % 26);
+            }
+        } else if (kind == "long-tokens"){
+            const std::size_t length = 64 + rng() % 512;
+            for (std::size_t i = 0; i < length; ++i){
+                out += static_cast<char>('a' + rng() % 26);
+            }
+            out += ' ';
+        } else {
+            out += utf8_words[rng() % utf8_words.size()];
+            out += (rng() % 10 == 0) ? "。" : " ";
+        }
+    }
+    out.resize(size);
+    // Do not leave a multi-byte sequence cut in half at the end; the UTF-8
+    // entry points should be measured on valid input.
+    std::size_t lead = out.size();
+    while (lead > 0 && lead + 4 > out.size() && (static_cast<unsigned char>(out[lead - 1]) & 0xC0) == 0x80){
+        --lead;
+    }
+    if (lead > 0){
+        const auto c = static_cast<unsigned char>(out[lead - 1]);
+        const std::size_t length = c < 0x80 ? 1 : c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : 2;
+        if (lead - 1 + length > out.size()){
+            out.resize(lead - 1);
+        }
+    }
+    return out;
+}
+
+struct Result {
+    double seconds_per_call;
+    double allocations_per_call;
+};
+
+Result measure(const std::function<std::uint64_t()>& call, std::size_t bytes){
+    using clock = std::chrono::steady_clock;
+    volatile std::uint64_t sink = call();   // warm-up, also faults pages in
+
+    // Enough iterations for ~0.2 s of work, but at least three.
+    const int iterations = static_cast<int>(std::clamp<double>(2e8 / std::max<std::size_t>(bytes, 1), 3, 2000));
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    const std::uint64_t allocations_before = g_allocations.load();
+    for (int i = 0; i < iterations; ++i){
+        const auto start = clock::now();
+        sink = sink + call();
+        samples.push_back(std::chrono::duration<double>(clock::now() - start).count());
+    }
+    const std::uint64_t allocations = g_allocations.load() - allocations_before;
+    (void)sink;
+
+    std::sort(samples.begin(), samples.end());
+    return Result{samples[samples.size() / 2], static_cast<double>(allocations) / iterations};
+}
+
+std::string human_size(std::size_t bytes){
+    if (bytes >= (std::size_t{1} << 20)){
+        return std::to_string(bytes >> 20) + "MiB";
+    }
+    return std::to_string(bytes >> 10) + "KiB";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]){
+    // Usage: bench [SIZE_KIB...]   (default: 64 4096 65536)
+    std::vector<std::size_t> sizes;
+    for (int i = 1; i < argc; ++i){
+        sizes.push_back(std::strtoull(argv[i], nullptr, 10) << 10);
+    }
+    if (sizes.empty()){
+        sizes = {std::size_t{64} << 10, std::size_t{4} << 20, std::size_t{64} << 20};
+    }
+
+    const std::vector<std::pair<std::string, std::function<std::uint64_t(const std::string&)>>> entry_points = {
+        {"count_words", [](const std::string& t){ return std::uint64_t(count_words(t)); }},
+        {"count_char", [](const std::string& t){ return std::uint64_t(count_char(t).size()); }},
+        {"count_words<Whitespace>", [](const std::string& t){ return std::uint64_t(count_words<WhitespacePolicy>(t)); }},
+        {"count_text_stats", [](const std::string& t){ return count_text_stats(t).words; }},
+        {"count_words_parallel", [](const std::string& t){ return std::uint64_t(count_words_parallel(t)); }},
+        {"count_char_parallel", [](const std::string& t){ return std::uint64_t(count_char_parallel(t).size()); }},
+        {"WordCounter(64KiB feeds)", [](const std::string& t){
+            WordCounter counter;
+            for (std::size_t i = 0; i < t.size(); i += 65536){
+                counter.feed(std::string_view(t).substr(i, 65536));
+            }
+            return counter.snapshot().words;
+        }},
+        {"count_word_frequencies", [](const std::string& t){ return std::uint64_t(count_word_frequencies(t).size()); }},
+        {"count_utf8", [](const std::string& t){ return count_utf8(t).words; }},
+    };
+
+    std::cout << std::left << std::setw(13) << "corpus" << std::setw(8) << "size"
+              << std::setw(26) << "entry point" << std::right << std::setw(10) << "GB/s"
+              << std::setw(10) << "ns/byte" << std::setw(12) << "allocs/call" << std::endl;
+
+    std::mt19937_64 rng(2026);
+    for (const std::string kind : {"ascii-prose", "punctuation", "long-tokens", "utf8-heavy"}){
+        for (std::size_t size : sizes){
+            const std::string text = make_corpus(kind, size, rng);
+            for (const auto& [name, fn] : entry_points){
+                const Result r = measure([&]{ return fn(text); }, text.size());
+                std::cout << std::left << std::setw(13) << kind << std::setw(8) << human_size(size)
+                          << std::setw(26) << name << std::right << std::fixed
+                          << std::setw(10) << std::setprecision(2) << text.size() / r.seconds_per_call / 1e9
+                          << std::setw(10) << std::setprecision(3) << r.seconds_per_call * 1e9 / text.size()
+                          << std::setw(12) << std::setprecision(1) << r.allocations_per_call << std::endl;
+            }
+        }
+    }
+    return 0;
+}
\ No newline at end of file
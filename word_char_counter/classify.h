@@ -0,0 +1,94 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "scan.h"
+
+// table[c] is true for bytes that belong to a word.
+using ClassTable = std::array<bool, 256>;
+
+template <class IsWordByte>
+constexpr ClassTable make_class_table(IsWordByte is_word){
+    ClassTable table{};
+    for (int c = 0; c < 256; ++c){
+        table[c] = is_word(static_cast<unsigned char>(c));
+    }
+    return table;
+}
+
+// The same set as nibble tables, for the SIMD kernel in scan.h.
+constexpr NibbleClassifier make_nibble_classifier(const ClassTable& table){
+    NibbleClassifier classifier{};
+    for (int c = 0; c < 256; ++c){
+        if (table[c]){
+            auto& half = c < 0x80 ? classifier.low_half : classifier.high_half;
+            half[c & 15] = static_cast<std::uint8_t>(half[c & 15] | (1u << ((c >> 4) & 7)));
+        }
+    }
+    return classifier;
+}
+
+// A classification policy is any type with a static constexpr ClassTable
+// named `table`. The table is built by the compiler, so classifying a byte
+// is a single load whatever the rule, and count_words<Policy> turns it into
+// shuffle tables for the SIMD kernel.
+
+// [0-9A-Za-z], the rule count_words has always used.
+struct AlnumPolicy {
+    static constexpr ClassTable table = make_class_table([](unsigned char c){
+        return is_word_byte(c);
+    });
+};
+
+// Identifiers: [0-9A-Za-z_].
+struct AlnumUnderscorePolicy {
+    static constexpr ClassTable table = make_class_table([](unsigned char c){
+        return is_word_byte(c) || c == '_';
+    });
+};
+
+// English words with contractions: [A-Za-z'].
+struct LetterApostrophePolicy {
+    static constexpr ClassTable table = make_class_table([](unsigned char c){
+        return ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') || c == '\'';
+    });
+};
+
+// Every byte except the listed delimiters is part of a word.
+template <char... Delimiters>
+struct DelimiterPolicy {
+    static constexpr ClassTable table = make_class_table([](unsigned char c){
+        return ((c != static_cast<unsigned char>(Delimiters)) && ...);
+    });
+};
+
+// Whitespace-separated tokens, like `wc -w`.
+using WhitespacePolicy = DelimiterPolicy<' ', '\t', '\n', '\v', '\f', '\r'>;
+
+// count_word_starts for an arbitrary policy. AlnumPolicy keeps its
+// range-compare kernel; other policies run the shuffle kernel on nibble
+// tables built from their table at compile time.
+template <class Policy>
+std::uint64_t
+count_word_starts_as(const char* data, std::size_t size, bool& prev_in_word){
+    if constexpr (std::is_same_v<Policy, AlnumPolicy>){
+        return count_word_starts(data, size, prev_in_word);
+    } else {
+        static constexpr NibbleClassifier words = make_nibble_classifier(Policy::table);
+        return count_word_starts(data, size, words, prev_in_word);
+    }
+}
+
+// fold_word_histogram for an arbitrary policy: keeps the policy's word
+// bytes and merges A-Z into a-z.
+template <class Policy>
+ByteHistogram fold_histogram_as(const ByteHistogram& raw){
+    ByteHistogram folded{};
+    for (int b = 0; b < 256; ++b){
+        if (raw[b] != 0 && Policy::table[b]){
+            folded[(b >= 'A' && b <= 'Z') ? (b | 0x20) : b] += raw[b];
+        }
+    }
+    return folded;
+}
\ No newline at end of file
@@ -0,0 +1,195 @@
+#include "crawl.h"
+#include <algorithm>
+#include <deque>
+#include <filesystem>
+#include <thread>
+#include "input.h"
+#include "scan.h"
+#include "thread_pool.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct PartialCounts {
+    std::size_t file = 0;      // index into the file list
+    std::uint64_t words = 0;
+    std::uint64_t chars = 0;
+    std::string error;
+};
+
+std::uint64_t word_chars(const ByteHistogram& raw){
+    const ByteHistogram folded = fold_word_histogram(raw);
+    std::uint64_t total = 0;
+    for (std::uint64_t n : folded){
+        total += n;
+    }
+    return total;
+}
+
+// Counts [offset, offset + length) of a file. The byte before offset is
+// mapped too so a word crossing the chunk start is not counted twice.
+void count_chunk(const std::string& path, std::size_t offset, std::size_t length,
+                 PartialCounts& out){
+    const std::size_t lead = offset > 0 ? 1 : 0;
+    MappedFile chunk(path, offset - lead, length + lead);
+    if (chunk.size() <= lead){
+        return;
+    }
+    bool in_word = lead != 0 && is_word_byte(static_cast<unsigned char>(chunk.data()[0]));
+    ByteHistogram raw{};
+    out.words += count_word_starts(chunk.data() + lead, chunk.size() - lead, in_word);
+    accumulate_histogram(chunk.data() + lead, chunk.size() - lead, raw);
+    out.chars += word_chars(raw);
+}
+
+// Runs work while holding one of the buffer slots, recording any error
+// against the file instead of failing the whole crawl.
+template <class Work>
+void with_buffer(Semaphore& buffers, PartialCounts& out, Work&& work){
+    buffers.acquire();
+    try {
+        work();
+    } catch (const std::exception& e){
+        out.error = e.what();
+    }
+    buffers.release();
+}
+
+void count_whole(const std::string& path, PartialCounts& out){
+    bool in_word = false;
+    ByteHistogram raw{};
+    for_each_chunk(path, kDefaultChunkSize, [&](const char* data, std::size_t size){
+        out.words += count_word_starts(data, size, in_word);
+        accumulate_histogram(data, size, raw);
+    });
+    out.chars += word_chars(raw);
+}
+
+} // namespace
+
+void walk_tree(const std::string& root,
+               const std::function<void(const std::string& path, std::uint64_t size)>& on_file,
+               const std::function<void(const std::string& path, const std::string& reason)>& on_error){
+    std::error_code ec;
+    const fs::file_status status = fs::status(root, ec);
+    if (!ec && fs::is_regular_file(status)){
+        const std::uintmax_t size = fs::file_size(root, ec);
+        if (!ec){
+            on_file(root, size);
+            return;
+        }
+    }
+    if (ec || !fs::is_directory(status)){
+        on_error(root, ec ? ec.message() : "not a file or directory");
+        return;
+    }
+    // An explicit stack instead of recursive_directory_iterator, which
+    // ends the whole walk on its first error: a directory or entry that
+    // cannot be read is reported and the walk goes on.
+    std::vector<fs::path> directories{fs::path(root)};
+    while (!directories.empty()){
+        const fs::path directory = std::move(directories.back());
+        directories.pop_back();
+        std::error_code dir_ec;
+        for (fs::directory_iterator it(directory, dir_ec), end; !dir_ec && it != end; it.increment(dir_ec)){
+            std::error_code entry_ec;
+            const fs::file_status link = it->symlink_status(entry_ec);
+            if (!entry_ec && fs::is_directory(link)){
+                directories.push_back(it->path());
+            } else if (!entry_ec){
+                const fs::file_status target = fs::is_symlink(link) ? it->status(entry_ec) : link;
+                if (entry_ec == std::errc::no_such_file_or_directory){
+                    entry_ec.clear();
+                }
+                if (!entry_ec && fs::is_regular_file(target)){
+                    const std::uintmax_t size = it->file_size(entry_ec);
+                    if (!entry_ec){
+                        on_file(it->path().string(), size);
+                    }
+                }
+            }
+            if (entry_ec){
+                on_error(it->path().string(), entry_ec.message());
+            }
+        }
+        if (dir_ec){
+            on_error(directory.string(), dir_ec.message());
+        }
+    }
+}
+
+std::vector<FileTotals>
+count_tree(const std::vector<std::string>& roots, const CrawlOptions& options){
+    const unsigned threads = options.threads != 0
+        ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<FileTotals> files;
+    // Workers write into elements while the walker appends more; a deque
+    // never moves existing elements, so their addresses stay valid.
+    std::deque<PartialCounts> partials;
+    std::vector<std::size_t> batch;
+    std::size_t batch_size = 0;
+    Semaphore buffers(options.max_open_buffers != 0 ? options.max_open_buffers : threads);
+    // Declared last so that, on any early exit, it drains its tasks before
+    // the state they point to is destroyed.
+    WorkStealingPool pool(threads);
+
+    auto flush_batch = [&]{
+        if (batch.empty()){
+            return;
+        }
+        std::vector<std::pair<std::string, PartialCounts*>> jobs;
+        for (std::size_t index : batch){
+            partials.push_back(PartialCounts{index, 0, 0, {}});
+            jobs.emplace_back(files[index].path, &partials.back());
+        }
+        pool.submit([jobs = std::move(jobs), &buffers]{
+            for (const auto& job : jobs){
+                with_buffer(buffers, *job.second, [&]{ count_whole(job.first, *job.second); });
+            }
+        });
+        batch.clear();
+        batch_size = 0;
+    };
+
+    auto schedule = [&](const std::string& path, std::uint64_t size){
+        const std::size_t index = files.size();
+        files.push_back(FileTotals{path, 0, 0, size, {}});
+        if (size > options.split_size){
+            for (std::size_t offset = 0; offset < size; offset += options.chunk_size){
+                partials.push_back(PartialCounts{index, 0, 0, {}});
+                PartialCounts* out = &partials.back();
+                pool.submit([path = files[index].path, offset, &options, out, &buffers]{
+                    with_buffer(buffers, *out, [&]{ count_chunk(path, offset, options.chunk_size, *out); });
+                });
+            }
+            return;
+        }
+        batch.push_back(index);
+        batch_size += static_cast<std::size_t>(size);
+        if (batch_size >= options.batch_bytes){
+            flush_batch();
+        }
+    };
+
+    for (const auto& root : roots){
+        walk_tree(root, schedule, [&](const std::string& path, const std::string& reason){
+            files.push_back(FileTotals{path, 0, 0, 0, reason});
+        });
+    }
+    flush_batch();
+    pool.wait();
+
+    for (const auto& partial : partials){
+        FileTotals& file = files[partial.file];
+        file.words += partial.words;
+        file.chars += partial.chars;
+        if (!partial.error.empty() && file.error.empty()){
+            file.error = partial.error;
+        }
+    }
+    std::sort(files.begin(), files.end(), [](const FileTotals& a, const FileTotals& b){
+        return a.path < b.path;
+    });
+    return files;
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct FileTotals {
+    std::string path;
+    std::uint64_t words = 0;
+    std::uint64_t chars = 0;   // word characters, as summed from count_char
+    std::uint64_t bytes = 0;
+    std::string error;         // non-empty if the file or directory could not be read
+};
+
+struct CrawlOptions {
+    unsigned threads = 0;                                 // 0: one per hardware thread
+    std::size_t max_open_buffers = 0;                     // 0: same as threads
+    std::size_t split_size = std::size_t{64} << 20;       // files above this are chunked
+    std::size_t chunk_size = std::size_t{16} << 20;
+    std::size_t batch_bytes = std::size_t{1} << 20;       // small files are grouped up to this
+};
+
+// Calls on_file(path, size) for root if it is a regular file, or for every
+// regular file under it if it is a directory. A root, directory or entry that
+// cannot be read is passed to on_error(path, reason) and the walk goes on.
+// Symlinks are followed to files but not to directories; dangling ones are
+// skipped.
+void walk_tree(const std::string& root,
+               const std::function<void(const std::string& path, std::uint64_t size)>& on_file,
+               const std::function<void(const std::string& path, const std::string& reason)>& on_error);
+
+// Counts every regular file under each root (a root may also be a single
+// file), wc-style. Work is spread over a work-stealing pool: big files are
+// split into chunks counted in parallel, small files are grouped into
+// batches so per-task overhead stays low, and at most max_open_buffers
+// files or chunks are mapped at any moment. Results are sorted by path.
+std::vector<FileTotals>
+count_tree(const std::vector<std::string>& roots, const CrawlOptions& options = {});
\ No newline at end of file
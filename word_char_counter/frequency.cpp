@@ -0,0 +1,280 @@
+#include "frequency.h"
+#include <algorithm>
+#include <cstring>
+#include <queue>
+#include <utility>
+#include "hash.h"
+#include "tokenize.h"
+
+StringArena::StringArena(std::size_t block_size) : block_size_(block_size) {}
+
+std::string_view StringArena::store(std::string_view bytes){
+    if (bytes.size() > capacity_ - used_){
+        // Oversized keys get a block of their own so one long token does not
+        // waste the tail of a regular block.
+        const std::size_t size = std::max(block_size_, bytes.size());
+        blocks_.emplace_back(new char[size]);
+        used_ = 0;
+        capacity_ = size;
+        reserved_ += size;
+    }
+    char* dest = blocks_.back().get() + used_;
+    std::memcpy(dest, bytes.data(), bytes.size());
+    used_ += bytes.size();
+    return std::string_view(dest, bytes.size());
+}
+
+static std::size_t round_up_pow2(std::size_t n){
+    std::size_t p = 16;
+    while (p < n){
+        p <<= 1;
+    }
+    return p;
+}
+
+FrequencyTable::FrequencyTable(std::size_t expected_words)
+    : slots_(round_up_pow2(expected_words + expected_words / 2), Slot{0, 0, nullptr, 0}),
+      mask_(slots_.size() - 1) {}
+
+FrequencyTable::Slot&
+FrequencyTable::find_or_insert(std::string_view word, std::uint64_t hash, bool& inserted){
+    // Keep the load factor below 0.7 so probe sequences stay short.
+    if ((size_ + 1) * 10 > slots_.size() * 7){
+        grow();
+    }
+    std::size_t i = hash & mask_;
+    for (;;){
+        Slot& slot = slots_[i];
+        if (slot.count == 0){
+            inserted = true;
+            slot.hash = hash;
+            slot.length = static_cast<std::uint32_t>(word.size());
+            ++size_;
+            return slot;
+        }
+        if (slot.hash == hash && slot.length == word.size()
+            && std::memcmp(slot.data, word.data(), word.size()) == 0){
+            inserted = false;
+            return slot;
+        }
+        i = (i + 1) & mask_;
+    }
+}
+
+void FrequencyTable::grow(){
+    std::vector<Slot> old(slots_.size() * 2, Slot{0, 0, nullptr, 0});
+    old.swap(slots_);
+    mask_ = slots_.size() - 1;
+    for (const Slot& slot : old){
+        if (slot.count != 0){
+            std::size_t i = slot.hash & mask_;
+            while (slots_[i].count != 0){
+                i = (i + 1) & mask_;
+            }
+            slots_[i] = slot;
+        }
+    }
+}
+
+void FrequencyTable::add(std::string_view word, std::uint64_t n){
+    bool inserted = false;
+    Slot& slot = find_or_insert(word, hash_bytes(word.data(), word.size()), inserted);
+    if (inserted){
+        slot.data = arena_.store(word).data();
+    }
+    slot.count += n;
+    total_ += n;
+}
+
+void FrequencyTable::add_view(std::string_view word, std::uint64_t n){
+    bool inserted = false;
+    Slot& slot = find_or_insert(word, hash_bytes(word.data(), word.size()), inserted);
+    if (inserted){
+        slot.data = word.data();
+    }
+    slot.count += n;
+    total_ += n;
+}
+
+std::uint64_t FrequencyTable::count(std::string_view word) const{
+    const std::uint64_t hash = hash_bytes(word.data(), word.size());
+    for (std::size_t i = hash & mask_; slots_[i].count != 0; i = (i + 1) & mask_){
+        const Slot& slot = slots_[i];
+        if (slot.hash == hash && slot.length == word.size()
+            && std::memcmp(slot.data, word.data(), word.size()) == 0){
+            return slot.count;
+        }
+    }
+    return 0;
+}
+
+// True if a should be reported before b.
+static bool ranks_before(const WordCount& a, const WordCount& b){
+    return a.count != b.count ? a.count > b.count : a.word < b.word;
+}
+
+std::vector<WordCount> FrequencyTable::top_k(std::size_t k) const{
+    // Min-heap of the best k seen so far: the root is the weakest candidate.
+    std::priority_queue<WordCount, std::vector<WordCount>, decltype(&ranks_before)> heap(ranks_before);
+    if (k == 0){
+        return {};
+    }
+    for_each([&](const WordCount& wc){
+        if (heap.size() < k){
+            heap.push(wc);
+        } else if (ranks_before(wc, heap.top())){
+            heap.pop();
+            heap.push(wc);
+        }
+    });
+    std::vector<WordCount> result(heap.size());
+    for (auto it = result.rbegin(); it != result.rend(); ++it){
+        *it = heap.top();
+        heap.pop();
+    }
+    return result;
+}
+
+FrequencyTable count_word_frequencies(std::string_view text){
+    FrequencyTable table;
+    for_each_word(text.data(), text.size(), [&](std::string_view word){
+        table.add_view(word);
+    });
+    return table;
+}
+
+HeavyHitters::HeavyHitters(std::size_t capacity)
+    : capacity_(std::max<std::size_t>(1, capacity)),
+      index_(round_up_pow2(2 * std::max<std::size_t>(1, capacity)), 0),
+      index_mask_(index_.size() - 1){
+    heap_.reserve(capacity_);
+    hashes_.reserve(capacity_);
+}
+
+std::size_t HeavyHitters::lookup(std::string_view word, std::uint64_t hash) const{
+    for (std::size_t i = hash & index_mask_; index_[i] != 0; i = (i + 1) & index_mask_){
+        const std::size_t pos = index_[i] - 1;
+        if (hashes_[pos] == hash && heap_[pos].word == word){
+            return pos;
+        }
+    }
+    return heap_.size();
+}
+
+void HeavyHitters::index_insert(std::size_t entry){
+    std::size_t i = hashes_[entry] & index_mask_;
+    while (index_[i] != 0){
+        i = (i + 1) & index_mask_;
+    }
+    index_[i] = static_cast<std::uint32_t>(entry + 1);
+}
+
+void HeavyHitters::index_erase(std::string_view word, std::uint64_t hash){
+    std::size_t i = hash & index_mask_;
+    while (index_[i] != 0){
+        const std::size_t pos = index_[i] - 1;
+        if (hashes_[pos] == hash && heap_[pos].word == word){
+            break;
+        }
+        i = (i + 1) & index_mask_;
+    }
+    if (index_[i] == 0){
+        return;
+    }
+    // Backward-shift deletion keeps every remaining key reachable from its
+    // home slot without tombstones.
+    index_[i] = 0;
+    for (std::size_t j = (i + 1) & index_mask_; index_[j] != 0; j = (j + 1) & index_mask_){
+        const std::size_t home = hashes_[index_[j] - 1] & index_mask_;
+        const bool movable = (j > i) ? (home <= i || home > j) : (home <= i && home > j);
+        if (movable){
+            index_[i] = index_[j];
+            index_[j] = 0;
+            i = j;
+        }
+    }
+}
+
+void HeavyHitters::swap_entries(std::size_t a, std::size_t b){
+    // Re-point the index slots of both entries before swapping them.
+    std::size_t slot_a = hashes_[a] & index_mask_;
+    while (index_[slot_a] != a + 1){
+        slot_a = (slot_a + 1) & index_mask_;
+    }
+    std::size_t slot_b = hashes_[b] & index_mask_;
+    while (index_[slot_b] != b + 1){
+        slot_b = (slot_b + 1) & index_mask_;
+    }
+    std::swap(index_[slot_a], index_[slot_b]);
+    std::swap(heap_[a], heap_[b]);
+    std::swap(hashes_[a], hashes_[b]);
+}
+
+void HeavyHitters::sift_up(std::size_t pos){
+    while (pos > 0){
+        const std::size_t parent = (pos - 1) / 2;
+        if (heap_[parent].count <= heap_[pos].count){
+            return;
+        }
+        swap_entries(pos, parent);
+        pos = parent;
+    }
+}
+
+void HeavyHitters::sift_down(std::size_t pos){
+    for (;;){
+        std::size_t smallest = pos;
+        const std::size_t left = 2 * pos + 1;
+        const std::size_t right = left + 1;
+        if (left < heap_.size() && heap_[left].count < heap_[smallest].count){
+            smallest = left;
+        }
+        if (right < heap_.size() && heap_[right].count < heap_[smallest].count){
+            smallest = right;
+        }
+        if (smallest == pos){
+            return;
+        }
+        swap_entries(pos, smallest);
+        pos = smallest;
+    }
+}
+
+void HeavyHitters::add(std::string_view word){
+    ++total_;
+    const std::uint64_t hash = hash_bytes(word.data(), word.size());
+    std::size_t pos = lookup(word, hash);
+    if (pos < heap_.size()){
+        ++heap_[pos].count;
+        sift_down(pos);
+        return;
+    }
+    if (heap_.size() < capacity_){
+        heap_.push_back(Entry{std::string(word), 1, 0});
+        hashes_.push_back(hash);
+        index_insert(heap_.size() - 1);
+        sift_up(heap_.size() - 1);
+        return;
+    }
+    // Replace the word with the smallest count; the new word inherits that
+    // count as its possible overestimate.
+    Entry& root = heap_[0];
+    index_erase(root.word, hashes_[0]);
+    root.error = root.count;
+    root.count += 1;
+    root.word.assign(word.data(), word.size());
+    hashes_[0] = hash;
+    index_insert(0);
+    sift_down(0);
+}
+
+std::vector<HeavyHitters::Entry> HeavyHitters::top_k(std::size_t k) const{
+    std::vector<Entry> result(heap_.begin(), heap_.end());
+    std::sort(result.begin(), result.end(), [](const Entry& a, const Entry& b){
+        return a.count != b.count ? a.count > b.count : a.word < b.word;
+    });
+    if (result.size() > k){
+        result.resize(k);
+    }
+    return result;
+}
\ No newline at end of file
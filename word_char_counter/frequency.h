@@ -0,0 +1,113 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct WordCount {
+    std::string_view word;
+    std::uint64_t count = 0;
+};
+
+// Append-only byte storage. Views returned by store() stay valid for the
+// lifetime of the arena because blocks are never moved or freed early.
+class StringArena {
+public:
+    explicit StringArena(std::size_t block_size = std::size_t{1} << 16);
+    std::string_view store(std::string_view bytes);
+    std::size_t bytes_reserved() const { return reserved_; }
+
+private:
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    std::size_t block_size_;
+    std::size_t used_ = 0;
+    std::size_t capacity_ = 0;
+    std::size_t reserved_ = 0;
+};
+
+// Word -> count map using open addressing with linear probing over a flat
+// slot array. Keys are either copied into an internal arena (add) or kept as
+// views into a buffer the caller keeps alive (add_view).
+class FrequencyTable {
+public:
+    explicit FrequencyTable(std::size_t expected_words = 1024);
+
+    void add(std::string_view word, std::uint64_t n = 1);
+    void add_view(std::string_view word, std::uint64_t n = 1);
+
+    std::uint64_t count(std::string_view word) const;
+    std::size_t size() const { return size_; }
+    std::uint64_t total() const { return total_; }
+
+    // The k most frequent words, most frequent first; ties are broken by
+    // byte order of the word so the result is deterministic.
+    std::vector<WordCount> top_k(std::size_t k) const;
+
+    template <class F>
+    void for_each(F&& f) const {
+        for (const auto& slot : slots_){
+            if (slot.count != 0){
+                f(WordCount{std::string_view(slot.data, slot.length), slot.count});
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        std::uint64_t hash;
+        std::uint64_t count;   // 0 marks an empty slot
+        const char* data;
+        std::uint32_t length;
+    };
+
+    Slot& find_or_insert(std::string_view word, std::uint64_t hash, bool& inserted);
+    void grow();
+
+    std::vector<Slot> slots_;
+    std::size_t mask_ = 0;
+    std::size_t size_ = 0;
+    std::uint64_t total_ = 0;
+    StringArena arena_;
+};
+
+// Frequencies of the words count_words would count. Keys are views into
+// text, which must outlive the returned table.
+FrequencyTable count_word_frequencies(std::string_view text);
+
+// Space-Saving heavy-hitters sketch: tracks at most `capacity` words no
+// matter how many distinct words the stream has. Any word occurring more
+// than total/capacity times is guaranteed to be tracked, and each reported
+// count overestimates the true count by at most its error() bound.
+class HeavyHitters {
+public:
+    struct Entry {
+        std::string word;
+        std::uint64_t count = 0;
+        std::uint64_t error = 0;
+    };
+
+    explicit HeavyHitters(std::size_t capacity);
+
+    void add(std::string_view word);
+    std::uint64_t total() const { return total_; }
+
+    // Tracked words, largest estimated count first.
+    std::vector<Entry> top_k(std::size_t k) const;
+
+private:
+    std::size_t lookup(std::string_view word, std::uint64_t hash) const;
+    void index_insert(std::size_t entry);
+    void index_erase(std::string_view word, std::uint64_t hash);
+    void sift_up(std::size_t pos);
+    void sift_down(std::size_t pos);
+    void swap_entries(std::size_t a, std::size_t b);
+
+    std::size_t capacity_;
+    std::uint64_t total_ = 0;
+    std::vector<Entry> heap_;             // min-heap on count
+    std::vector<std::uint64_t> hashes_;   // parallel to heap_
+    std::vector<std::uint32_t> index_;    // open-addressed: heap position + 1, 0 = empty
+    std::size_t index_mask_;
+};
\ No newline at end of file
@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""Regenerates unicode_tables.cpp from Python's unicodedata module.
+
+    python3 gen_unicode_tables.py > unicode_tables.cpp
+"""
+import sys
+import unicodedata
+
+MAX_CP = 0x110000
+BLOCK = 256
+
+
+def category(cp):
+    cat = unicodedata.category(chr(cp))
+    if cat[0] == "L":
+        return 1  # Letter
+    if cat == "Nd":
+        return 2  # Digit
+    return 0
+
+
+def packed_block(cats):
+    out = []
+    for i in range(0, BLOCK, 4):
+        byte = 0
+        for j in range(4):
+            byte |= cats[i + j] << (2 * j)
+        out.append(byte)
+    return tuple(out)
+
+
+def lower_runs():
+    pairs = []
+    for cp in range(0x80, MAX_CP):
+        low = chr(cp).lower()
+        if len(low) == 1 and ord(low) != cp:
+            pairs.append((cp, ord(low) - cp))
+    runs = []  # [first, last, stride, delta]
+    for cp, delta in pairs:
+        if runs:
+            run = runs[-1]
+            stride = cp - run[1]
+            if run[3] == delta and stride in (1, 2) and (run[0] == run[1] or run[2] == stride):
+                run[1] = cp
+                run[2] = stride
+                continue
+        runs.append([cp, cp, 1, delta])
+    return runs
+
+
+def main():
+    cats = [category(cp) for cp in range(MAX_CP)]
+    blocks = {}
+    stage1 = []
+    for b in range(MAX_CP // BLOCK):
+        key = packed_block(cats[b * BLOCK:(b + 1) * BLOCK])
+        stage1.append(blocks.setdefault(key, len(blocks)))
+    assert len(blocks) <= 256
+
+    out = sys.stdout
+    out.write("// Generated by gen_unicode_tables.py from Unicode %s. Do not edit.\n"
+              % unicodedata.unidata_version)
+    out.write('#include "unicode_tables.h"\n\n')
+    out.write("namespace {\n\n")
+    out.write("// Block index for each 256-code-point page.\n")
+    out.write("const unsigned char kStage1[%d] = {\n" % len(stage1))
+    for i in range(0, len(stage1), 24):
+        out.write("    " + ",".join(str(v) for v in stage1[i:i + 24]) + ",\n")
+    out.write("};\n\n")
+    out.write("// Two bits per code point: 0 other, 1 letter, 2 digit.\n")
+    out.write("const unsigned char kStage2[%d][%d] = {\n" % (len(blocks), BLOCK // 4))
+    for key in sorted(blocks, key=blocks.get):
+        out.write("    {" + ",".join(str(v) for v in key) + "},\n")
+    out.write("};\n\n")
+    runs = lower_runs()
+    out.write("struct LowerRun {\n    char32_t first;\n    char32_t last;\n"
+              "    unsigned char stride;\n    int delta;\n};\n\n")
+    out.write("// Simple (one-to-one) lower-case mappings outside ASCII, as runs of\n")
+    out.write("// code points sharing the same offset.\n")
+    out.write("const LowerRun kLowerRuns[%d] = {\n" % len(runs))
+    for first, last, stride, delta in runs:
+        out.write("    {0x%X, 0x%X, %d, %d},\n" % (first, last, stride, delta))
+    out.write("};\n\n")
+    out.write("} // namespace\n\n")
+    out.write("""CharCategory char_category(char32_t cp){
+    if (cp >= 0x110000){
+        return CharCategory::Other;
+    }
+    const unsigned char packed = kStage2[kStage1[cp >> 8]][(cp & 0xFF) >> 2];
+    return static_cast<CharCategory>((packed >> ((cp & 3) * 2)) & 3);
+}
+
+char32_t to_lower(char32_t cp){
+    if (cp < 0x80){
+        return (cp >= 'A' && cp <= 'Z') ? cp + 0x20 : cp;
+    }
+    std::size_t lo = 0;
+    std::size_t hi = sizeof(kLowerRuns) / sizeof(kLowerRuns[0]);
+    while (lo < hi){
+        const std::size_t mid = (lo + hi) / 2;
+        if (kLowerRuns[mid].last < cp){
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < sizeof(kLowerRuns) / sizeof(kLowerRuns[0])){
+        const LowerRun& run = kLowerRuns[lo];
+        if (cp >= run.first && (cp - run.first) % run.stride == 0){
+            return static_cast<char32_t>(static_cast<int>(cp) + run.delta);
+        }
+    }
+    return cp;
+}
+""")
+
+
+if __name__ == "__main__":
+    main()
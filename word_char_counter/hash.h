@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Final avalanche step (from MurmurHash3's fmix64).
+inline std::uint64_t mix64(std::uint64_t h){
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// Fast non-cryptographic hash for short keys; reads eight bytes at a time.
+inline std::uint64_t hash_bytes(const char* data, std::size_t size){
+    constexpr std::uint64_t kMul = 0x9e3779b97f4a7c15ULL;
+    std::uint64_t h = size * kMul;
+    while (size >= 8){
+        std::uint64_t v;
+        std::memcpy(&v, data, 8);
+        h = (h ^ v) * kMul;
+        h ^= h >> 31;
+        data += 8;
+        size -= 8;
+    }
+    if (size > 0){
+        std::uint64_t v = 0;
+        std::memcpy(&v, data, size);
+        h = (h ^ v) * kMul;
+    }
+    return mix64(h);
+}
\ No newline at end of file
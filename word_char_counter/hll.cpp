@@ -0,0 +1,110 @@
+#include "hll.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "hash.h"
+#include "tokenize.h"
+
+HyperLogLog::HyperLogLog(unsigned precision)
+    : precision_(precision){
+    if (precision < kMinPrecision || precision > kMaxPrecision){
+        throw std::invalid_argument("HyperLogLog precision must be between "
+                                    + std::to_string(kMinPrecision) + " and "
+                                    + std::to_string(kMaxPrecision));
+    }
+    registers_.assign(std::size_t{1} << precision, 0);
+}
+
+void HyperLogLog::add(std::string_view item){
+    add_hash(hash_bytes(item.data(), item.size()));
+}
+
+void HyperLogLog::add_hash(std::uint64_t hash){
+    // Top bits pick the register; the rank is the position of the first set
+    // bit in the rest.
+    const std::size_t index = hash >> (64 - precision_);
+    const std::uint64_t rest = hash << precision_;
+    const auto rank = static_cast<std::uint8_t>(
+        rest == 0 ? 64 - precision_ + 1 : __builtin_clzll(rest) + 1);
+    registers_[index] = std::max(registers_[index], rank);
+}
+
+void HyperLogLog::merge(const HyperLogLog& other){
+    if (other.precision_ != precision_){
+        throw std::invalid_argument("Cannot merge HyperLogLog sketches of different precision");
+    }
+    for (std::size_t i = 0; i < registers_.size(); ++i){
+        registers_[i] = std::max(registers_[i], other.registers_[i]);
+    }
+}
+
+std::uint64_t HyperLogLog::estimate() const{
+    const double m = static_cast<double>(registers_.size());
+    double sum = 0.0;
+    std::size_t zeros = 0;
+    for (std::uint8_t r : registers_){
+        sum += std::ldexp(1.0, -static_cast<int>(r));
+        zeros += (r == 0);
+    }
+    double alpha;
+    switch (registers_.size()){
+        case 16: alpha = 0.673; break;
+        case 32: alpha = 0.697; break;
+        case 64: alpha = 0.709; break;
+        default: alpha = 0.7213 / (1.0 + 1.079 / m); break;
+    }
+    double estimate = alpha * m * m / sum;
+    // Small cardinalities: linear counting on the empty registers is far
+    // more accurate than the raw estimate.
+    if (estimate <= 2.5 * m && zeros != 0){
+        estimate = m * std::log(m / static_cast<double>(zeros));
+    }
+    return static_cast<std::uint64_t>(estimate + 0.5);
+}
+
+HyperLogLog
+sketch_distinct_words(const char* data, std::size_t size, unsigned precision, unsigned threads){
+    if (threads == 0){
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const auto workers = static_cast<unsigned>(
+        std::min<std::size_t>(threads, std::max<std::size_t>(1, size >> 20)));
+    std::vector<HyperLogLog> partial(workers, HyperLogLog(precision));
+
+    // Range t owns the words that start inside it: it skips a word already
+    // in progress at its start and finishes the word running past its end.
+    auto scan_range = [&](unsigned t){
+        std::size_t begin = size * t / workers;
+        std::size_t end = size * (t + 1) / workers;
+        if (begin > 0){
+            while (begin < size && is_word_byte(static_cast<unsigned char>(data[begin - 1]))
+                   && is_word_byte(static_cast<unsigned char>(data[begin]))){
+                ++begin;
+            }
+        }
+        if (begin >= end){
+            return;
+        }
+        while (end < size && is_word_byte(static_cast<unsigned char>(data[end]))){
+            ++end;
+        }
+        for_each_word(data + begin, end - begin, [&](std::string_view word){
+            partial[t].add(word);
+        });
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < workers; ++t){
+        pool.emplace_back(scan_range, t);
+    }
+    scan_range(0);
+    for (auto& th : pool){
+        th.join();
+    }
+    for (unsigned t = 1; t < workers; ++t){
+        partial[0].merge(partial[t]);
+    }
+    return partial[0];
+}
\ No newline at end of file
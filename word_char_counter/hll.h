@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// HyperLogLog distinct-count sketch. Uses 2^precision one-byte registers
+// (4 KiB at the default precision of 12, for a standard error of about
+// 1.04 / sqrt(2^precision) = 1.6%) however many items are added. Sketches
+// with the same precision can be merged, e.g. one per thread or per file.
+class HyperLogLog {
+public:
+    static constexpr unsigned kMinPrecision = 4;
+    static constexpr unsigned kMaxPrecision = 18;
+
+    // Throws std::invalid_argument if precision is out of range.
+    explicit HyperLogLog(unsigned precision = 12);
+
+    void add(std::string_view item);
+    void add_hash(std::uint64_t hash);
+
+    // Throws std::invalid_argument if the precisions differ.
+    void merge(const HyperLogLog& other);
+
+    std::uint64_t estimate() const;
+    unsigned precision() const { return precision_; }
+    std::size_t memory_bytes() const { return registers_.size(); }
+
+private:
+    unsigned precision_;
+    std::vector<std::uint8_t> registers_;
+};
+
+// Sketch of the distinct words (count_words rule) in [data, data + size),
+// built on `threads` threads (0: one per hardware thread) and merged.
+HyperLogLog
+sketch_distinct_words(const char* data, std::size_t size, unsigned precision = 12,
+                      unsigned threads = 1);
\ No newline at end of file
@@ -0,0 +1,308 @@
+#include "index.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+#include "crawl.h"
+#include "frequency.h"
+
+namespace {
+
+void put_varint(std::vector<unsigned char>& out, std::uint64_t value){
+    while (value >= 0x80){
+        out.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+std::uint64_t get_varint(const unsigned char*& p, const unsigned char* end){
+    std::uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7){
+        if (p == end){
+            throw std::runtime_error("Corrupt index: truncated posting list");
+        }
+        const unsigned char byte = *p++;
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0){
+            return value;
+        }
+    }
+    throw std::runtime_error("Corrupt index: varint too long");
+}
+
+std::uint64_t align8(std::uint64_t n){
+    return (n + 7) & ~std::uint64_t{7};
+}
+
+std::vector<std::string> list_files(const std::vector<std::string>& inputs, std::vector<std::string>& errors){
+    std::vector<std::string> files;
+    for (const auto& input : inputs){
+        walk_tree(input, [&](const std::string& path, std::uint64_t){
+            files.push_back(path);
+        }, [&](const std::string& path, const std::string& reason){
+            errors.push_back(path + ": " + reason);
+        });
+    }
+    std::sort(files.begin(), files.end());
+    files.erase(std::unique(files.begin(), files.end()), files.end());
+    return files;
+}
+
+} // namespace
+
+std::size_t build_index(const std::vector<std::string>& inputs, const std::string& out_path,
+                        std::vector<std::string>& errors){
+    const std::vector<std::string> candidates = list_files(inputs, errors);
+    if (candidates.size() > UINT32_MAX){
+        throw std::runtime_error("Too many files to index");
+    }
+
+    StringArena arena;
+    std::unordered_map<std::string_view, std::uint32_t> term_ids;
+    std::vector<std::string_view> terms;
+    std::vector<std::vector<Posting>> postings;
+    std::vector<std::uint64_t> totals;
+    std::vector<std::string> files;
+    std::vector<std::uint64_t> file_words;
+
+    for (const auto& path : candidates){
+        std::unique_ptr<MappedFile> file;
+        try {
+            file = std::make_unique<MappedFile>(path);
+        } catch (const std::runtime_error& e){
+            errors.push_back(e.what());
+            continue;
+        }
+        // The table's words point into the mapping, which outlives it.
+        const FrequencyTable table = count_word_frequencies(std::string_view(file->data(), file->size()));
+        const auto id = static_cast<std::uint32_t>(files.size());
+        files.push_back(path);
+        file_words.push_back(table.total());
+        table.for_each([&](const WordCount& wc){
+            auto it = term_ids.find(wc.word);
+            if (it == term_ids.end()){
+                const std::string_view stored = arena.store(wc.word);
+                it = term_ids.emplace(stored, static_cast<std::uint32_t>(terms.size())).first;
+                terms.push_back(stored);
+                postings.emplace_back();
+                totals.push_back(0);
+            }
+            postings[it->second].push_back(Posting{id, wc.count});
+            totals[it->second] += wc.count;
+        });
+    }
+
+    std::vector<std::uint32_t> order(terms.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b){
+        return terms[a] < terms[b];
+    });
+
+    // Lay out the string heap (terms, then paths) and the posting bytes.
+    std::string heap;
+    std::vector<unsigned char> posting_bytes;
+    std::vector<IndexTermEntry> term_entries;
+    term_entries.reserve(order.size());
+    for (std::uint32_t id : order){
+        IndexTermEntry entry{};
+        entry.term_offset = heap.size();
+        entry.term_length = static_cast<std::uint32_t>(terms[id].size());
+        entry.postings_offset = posting_bytes.size();
+        entry.doc_count = static_cast<std::uint32_t>(postings[id].size());
+        entry.total_count = totals[id];
+        heap.append(terms[id]);
+        std::uint32_t previous = 0;
+        for (const Posting& p : postings[id]){
+            put_varint(posting_bytes, p.file - previous);
+            put_varint(posting_bytes, p.count);
+            previous = p.file;
+        }
+        term_entries.push_back(entry);
+    }
+    std::vector<IndexFileEntry> file_entries;
+    for (std::uint32_t id = 0; id < files.size(); ++id){
+        IndexFileEntry entry{};
+        entry.path_offset = heap.size();
+        entry.path_length = static_cast<std::uint32_t>(files[id].size());
+        entry.words = file_words[id];
+        heap.append(files[id]);
+        file_entries.push_back(entry);
+    }
+
+    IndexHeader header{};
+    std::memcpy(header.magic, kIndexMagic, sizeof(kIndexMagic));
+    header.version = kIndexVersion;
+    header.file_count = file_entries.size();
+    header.term_count = term_entries.size();
+    header.files_offset = align8(sizeof(IndexHeader));
+    header.terms_offset = align8(header.files_offset + file_entries.size() * sizeof(IndexFileEntry));
+    header.strings_offset = align8(header.terms_offset + term_entries.size() * sizeof(IndexTermEntry));
+    header.postings_offset = align8(header.strings_offset + heap.size());
+    header.total_size = header.postings_offset + posting_bytes.size();
+
+    std::ofstream out(out_path, std::ios::binary | std::ios::trunc);
+    if (!out){
+        throw std::runtime_error("Could not create index file: " + out_path);
+    }
+    std::uint64_t written = 0;
+    auto write = [&](const void* data, std::size_t size){
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        written += size;
+    };
+    auto pad_to = [&](std::uint64_t offset){
+        static const char zeros[8] = {};
+        write(zeros, static_cast<std::size_t>(offset - written));
+    };
+    write(&header, sizeof(header));
+    pad_to(header.files_offset);
+    write(file_entries.data(), file_entries.size() * sizeof(IndexFileEntry));
+    pad_to(header.terms_offset);
+    write(term_entries.data(), term_entries.size() * sizeof(IndexTermEntry));
+    pad_to(header.strings_offset);
+    write(heap.data(), heap.size());
+    pad_to(header.postings_offset);
+    write(posting_bytes.data(), posting_bytes.size());
+    out.close();
+    if (!out){
+        throw std::runtime_error("Could not write index file: " + out_path);
+    }
+    return files.size();
+}
+
+IndexReader::IndexReader(const std::string& path) : file_(path){
+    auto corrupt = [&](const char* what){
+        return std::runtime_error("Not a valid index '" + path + "': " + what);
+    };
+    if (file_.size() < sizeof(IndexHeader)){
+        throw corrupt("too small");
+    }
+    header_ = reinterpret_cast<const IndexHeader*>(file_.data());
+    if (std::memcmp(header_->magic, kIndexMagic, sizeof(kIndexMagic)) != 0){
+        throw corrupt("bad magic");
+    }
+    if (header_->version != kIndexVersion){
+        throw corrupt("unsupported version");
+    }
+    const std::uint64_t size = file_.size();
+    if (header_->total_size != size
+        || header_->files_offset > size
+        || header_->file_count > (size - header_->files_offset) / sizeof(IndexFileEntry)
+        || header_->terms_offset > size
+        || header_->term_count > (size - header_->terms_offset) / sizeof(IndexTermEntry)
+        || header_->strings_offset > header_->postings_offset
+        || header_->postings_offset > size){
+        throw corrupt("section out of bounds");
+    }
+    files_ = reinterpret_cast<const IndexFileEntry*>(file_.data() + header_->files_offset);
+    terms_ = reinterpret_cast<const IndexTermEntry*>(file_.data() + header_->terms_offset);
+    strings_ = file_.data() + header_->strings_offset;
+    postings_ = reinterpret_cast<const unsigned char*>(file_.data() + header_->postings_offset);
+    postings_size_ = static_cast<std::size_t>(size - header_->postings_offset);
+}
+
+std::string_view IndexReader::file_path(std::uint32_t file) const{
+    const IndexFileEntry& entry = files_[file];
+    const std::uint64_t heap_size = header_->postings_offset - header_->strings_offset;
+    if (entry.path_offset > heap_size || entry.path_length > heap_size - entry.path_offset){
+        throw std::runtime_error("Corrupt index: file path out of bounds");
+    }
+    return std::string_view(strings_ + entry.path_offset, entry.path_length);
+}
+
+const IndexTermEntry* IndexReader::find(std::string_view term) const{
+    const std::uint64_t heap_size = header_->postings_offset - header_->strings_offset;
+    auto term_of = [&](const IndexTermEntry& entry){
+        if (entry.term_offset > heap_size || entry.term_length > heap_size - entry.term_offset){
+            throw std::runtime_error("Corrupt index: term out of bounds");
+        }
+        return std::string_view(strings_ + entry.term_offset, entry.term_length);
+    };
+    const IndexTermEntry* begin = terms_;
+    const IndexTermEntry* end = terms_ + header_->term_count;
+    const IndexTermEntry* it = std::lower_bound(begin, end, term,
+        [&](const IndexTermEntry& entry, std::string_view key){ return term_of(entry) < key; });
+    if (it == end || term_of(*it) != term){
+        return nullptr;
+    }
+    return it;
+}
+
+std::vector<Posting> IndexReader::decode(const IndexTermEntry& entry) const{
+    if (entry.postings_offset > postings_size_){
+        throw std::runtime_error("Corrupt index: posting list out of bounds");
+    }
+    const unsigned char* p = postings_ + entry.postings_offset;
+    const unsigned char* end = postings_ + postings_size_;
+    std::vector<Posting> result(entry.doc_count);
+    std::uint64_t file = 0;
+    for (auto& posting : result){
+        file += get_varint(p, end);
+        if (file >= header_->file_count){
+            throw std::runtime_error("Corrupt index: file id out of range");
+        }
+        posting.file = static_cast<std::uint32_t>(file);
+        posting.count = get_varint(p, end);
+    }
+    return result;
+}
+
+std::vector<Posting> IndexReader::lookup(std::string_view term) const{
+    const IndexTermEntry* entry = find(term);
+    return entry != nullptr ? decode(*entry) : std::vector<Posting>{};
+}
+
+std::vector<std::uint32_t>
+IndexReader::lookup_all(const std::vector<std::string>& terms,
+                        std::vector<std::vector<std::uint64_t>>& counts) const{
+    counts.clear();
+    std::vector<const IndexTermEntry*> entries;
+    for (const auto& term : terms){
+        const IndexTermEntry* entry = find(term);
+        if (entry == nullptr){
+            return {};
+        }
+        entries.push_back(entry);
+    }
+    if (entries.empty()){
+        return {};
+    }
+
+    // Start from the rarest term so every later step shrinks a short list.
+    std::vector<std::size_t> order(entries.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b){
+        return entries[a]->doc_count < entries[b]->doc_count;
+    });
+
+    std::vector<std::uint32_t> files;
+    for (const Posting& p : decode(*entries[order[0]])){
+        files.push_back(p.file);
+        counts.emplace_back(terms.size(), 0);
+        counts.back()[order[0]] = p.count;
+    }
+    for (std::size_t k = 1; k < order.size() && !files.empty(); ++k){
+        const std::vector<Posting> list = decode(*entries[order[k]]);
+        std::size_t kept = 0;
+        std::size_t j = 0;
+        for (std::size_t i = 0; i < files.size(); ++i){
+            while (j < list.size() && list[j].file < files[i]){
+                ++j;
+            }
+            if (j < list.size() && list[j].file == files[i]){
+                counts[i][order[k]] = list[j].count;
+                if (kept != i){
+                    files[kept] = files[i];
+                    counts[kept] = std::move(counts[i]);
+                }
+                ++kept;
+            }
+        }
+        files.resize(kept);
+        counts.resize(kept);
+    }
+    return files;
+}
\ No newline at end of file
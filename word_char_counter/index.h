@@ -0,0 +1,96 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "input.h"
+
+// On-disk inverted index: for every word, which files contain it and how
+// often. Everything is little-endian and addressed by offset, so a reader
+// maps the file and uses it in place:
+//
+//   IndexHeader
+//   IndexFileEntry[file_count]          paths live in the string heap
+//   IndexTermEntry[term_count]          sorted by term bytes
+//   string heap                         term and path bytes, no separators
+//   postings                            per term: doc_count pairs of
+//                                       varint(file id delta), varint(count)
+
+constexpr char kIndexMagic[8] = {'W', 'C', 'C', 'I', 'D', 'X', '\0', '\0'};
+constexpr std::uint32_t kIndexVersion = 1;
+
+struct IndexHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t file_count;
+    std::uint64_t term_count;
+    std::uint64_t files_offset;
+    std::uint64_t terms_offset;
+    std::uint64_t strings_offset;
+    std::uint64_t postings_offset;
+    std::uint64_t total_size;
+};
+
+struct IndexFileEntry {
+    std::uint64_t path_offset;     // relative to strings_offset
+    std::uint32_t path_length;
+    std::uint32_t reserved;
+    std::uint64_t words;
+};
+
+struct IndexTermEntry {
+    std::uint64_t term_offset;     // relative to strings_offset
+    std::uint64_t postings_offset; // relative to postings_offset
+    std::uint64_t total_count;
+    std::uint32_t term_length;
+    std::uint32_t doc_count;
+};
+
+// Counts the words of every file (directories are walked recursively) and
+// writes the index to out_path. Returns the number of files indexed. Inputs,
+// directories and files that cannot be read are left out and described in
+// errors; the rest are still indexed. Throws std::runtime_error if the index
+// cannot be written.
+std::size_t build_index(const std::vector<std::string>& inputs, const std::string& out_path,
+                        std::vector<std::string>& errors);
+
+struct Posting {
+    std::uint32_t file = 0;
+    std::uint64_t count = 0;
+};
+
+// Read-only view of an index file. Opening maps the file and checks the
+// header and section bounds; nothing is parsed or copied.
+class IndexReader {
+public:
+    // Throws std::runtime_error if the file is not a valid index.
+    explicit IndexReader(const std::string& path);
+
+    std::size_t file_count() const { return static_cast<std::size_t>(header_->file_count); }
+    std::size_t term_count() const { return static_cast<std::size_t>(header_->term_count); }
+    std::string_view file_path(std::uint32_t file) const;
+    std::uint64_t file_words(std::uint32_t file) const { return files_[file].words; }
+
+    // Files containing term, in file order; empty if the term is unknown.
+    std::vector<Posting> lookup(std::string_view term) const;
+
+    // Files containing every term. counts[i][t] is the count of terms[t] in
+    // result[i].
+    std::vector<std::uint32_t>
+    lookup_all(const std::vector<std::string>& terms,
+               std::vector<std::vector<std::uint64_t>>& counts) const;
+
+private:
+    const IndexTermEntry* find(std::string_view term) const;
+    std::vector<Posting> decode(const IndexTermEntry& entry) const;
+
+    MappedFile file_;
+    const IndexHeader* header_ = nullptr;
+    const IndexFileEntry* files_ = nullptr;
+    const IndexTermEntry* terms_ = nullptr;
+    const char* strings_ = nullptr;
+    const unsigned char* postings_ = nullptr;
+    std::size_t postings_size_ = 0;
+};
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include "input.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+std::runtime_error io_error(const std::string& what, const std::string& path){
+    return std::runtime_error(what + " '" + path + "': " + std::strerror(errno));
+}
+
+class FileDescriptor {
+public:
+    explicit FileDescriptor(int fd, bool owned) : fd_(fd), owned_(owned) {}
+    ~FileDescriptor(){
+        if (owned_ && fd_ >= 0){
+            ::close(fd_);
+        }
+    }
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+    int get() const { return fd_; }
+
+private:
+    int fd_;
+    bool owned_;
+};
+
+void map_windows(int fd, std::size_t file_size, std::size_t chunk_size,
+                 const std::string& path, const ChunkCallback& on_chunk){
+    const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const std::size_t window = (chunk_size + page - 1) / page * page;
+
+    for (std::size_t offset = 0; offset < file_size; offset += window){
+        const std::size_t length = std::min(window, file_size - offset);
+        void* addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd,
+                            static_cast<off_t>(offset));
+        if (addr == MAP_FAILED){
+            throw io_error("Could not map", path);
+        }
+        // Advice values are not flags and cannot be or-ed together.
+        ::madvise(addr, length, MADV_SEQUENTIAL);
+        ::madvise(addr, length, MADV_WILLNEED);
+        std::unique_ptr<void, std::function<void(void*)>> mapping(
+            addr, [length](void* p){ ::munmap(p, length); });
+        on_chunk(static_cast<const char*>(addr), length);
+    }
+}
+
+void read_stream(int fd, std::size_t chunk_size,
+                 const std::string& path, const ChunkCallback& on_chunk){
+    std::unique_ptr<char[]> buffer(new char[chunk_size]);
+    for (;;){
+        std::size_t filled = 0;
+        // Fill the whole buffer before handing it on, so a pipe delivering a
+        // few bytes at a time does not turn into thousands of tiny chunks.
+        while (filled < chunk_size){
+            const ssize_t n = ::read(fd, buffer.get() + filled, chunk_size - filled);
+            if (n < 0){
+                if (errno == EINTR){
+                    continue;
+                }
+                throw io_error("Could not read", path);
+            }
+            if (n == 0){
+                break;
+            }
+            filled += static_cast<std::size_t>(n);
+        }
+        if (filled == 0){
+            return;
+        }
+        on_chunk(buffer.get(), filled);
+        if (filled < chunk_size){
+            return;
+        }
+    }
+}
+
+} // namespace
+
+void for_each_chunk(const std::string& path, std::size_t chunk_size,
+                    const ChunkCallback& on_chunk){
+    if (chunk_size == 0){
+        throw std::invalid_argument("chunk size must be positive");
+    }
+    const bool is_stdin = path == "-";
+    FileDescriptor fd(is_stdin ? STDIN_FILENO : ::open(path.c_str(), O_RDONLY), !is_stdin);
+    if (fd.get() < 0){
+        throw io_error("Could not open", path);
+    }
+
+    struct stat info{};
+    if (::fstat(fd.get(), &info) != 0){
+        throw io_error("Could not stat", path);
+    }
+    if (S_ISDIR(info.st_mode)){
+        errno = EISDIR;
+        throw io_error("Could not read", path);
+    }
+
+    if (S_ISREG(info.st_mode) && ::lseek(fd.get(), 0, SEEK_CUR) == 0){
+        map_windows(fd.get(), static_cast<std::size_t>(info.st_size), chunk_size, path, on_chunk);
+    } else {
+        read_stream(fd.get(), chunk_size, path, on_chunk);
+    }
+}
+
+MappedFile::MappedFile(const std::string& path)
+    : MappedFile(path, 0, static_cast<std::size_t>(-1)) {}
+
+MappedFile::MappedFile(const std::string& path, std::size_t offset, std::size_t length){
+    FileDescriptor fd(::open(path.c_str(), O_RDONLY), true);
+    if (fd.get() < 0){
+        throw io_error("Could not open", path);
+    }
+    struct stat info{};
+    if (::fstat(fd.get(), &info) != 0){
+        throw io_error("Could not stat", path);
+    }
+    if (!S_ISREG(info.st_mode)){
+        errno = EINVAL;
+        throw io_error("Not a regular file", path);
+    }
+    const auto file_size = static_cast<std::size_t>(info.st_size);
+    if (offset >= file_size){
+        return;
+    }
+    size_ = std::min(length, file_size - offset);
+
+    // mmap offsets must be page aligned; map from the page holding offset.
+    const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const std::size_t aligned = offset / page * page;
+    mapped_ = size_ + (offset - aligned);
+    base_ = ::mmap(nullptr, mapped_, PROT_READ, MAP_PRIVATE, fd.get(),
+                   static_cast<off_t>(aligned));
+    if (base_ == MAP_FAILED){
+        base_ = nullptr;
+        throw io_error("Could not map", path);
+    }
+    ::madvise(base_, mapped_, MADV_WILLNEED);
+    data_ = static_cast<const char*>(base_) + (offset - aligned);
+}
+
+void MappedFile::unmap(){
+    if (base_ != nullptr){
+        ::munmap(base_, mapped_);
+    }
+    base_ = nullptr;
+    mapped_ = 0;
+    data_ = nullptr;
+    size_ = 0;
+}
+
+MappedFile::~MappedFile(){
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : base_(other.base_), mapped_(other.mapped_), data_(other.data_), size_(other.size_){
+    other.base_ = nullptr;
+    other.mapped_ = 0;
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept{
+    if (this != &other){
+        unmap();
+        std::swap(base_, other.base_);
+        std::swap(mapped_, other.mapped_);
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+    }
+    return *this;
+}
\ No newline at end of file
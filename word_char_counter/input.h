@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string>
+
+constexpr std::size_t kDefaultChunkSize = std::size_t{4} << 20;
+
+using ChunkCallback = std::function<void(const char* data, std::size_t size)>;
+
+// Feeds the contents of path ("-" for stdin) to on_chunk in order. Regular
+// files are mapped one window at a time, in pieces of chunk_size rounded up
+// to a whole number of pages; pipes and terminals are read into a single
+// reused buffer, in pieces of at most chunk_size bytes. Either way memory use
+// is bounded by chunk_size (plus a page), not by the size of the input.
+// Throws std::runtime_error if the input cannot be opened or read.
+void for_each_chunk(const std::string& path, std::size_t chunk_size,
+                    const ChunkCallback& on_chunk);
+
+// Read-only mapping of a regular file, or of the byte range
+// [offset, offset + length) of one, for callers that need random access
+// (e.g. splitting the file between threads). The range is clamped to the
+// end of the file. An empty mapping has data() == nullptr, size() == 0.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    MappedFile(const std::string& path, std::size_t offset, std::size_t length);
+    ~MappedFile();
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    void unmap();
+
+    void* base_ = nullptr;       // page-aligned start of the mapping
+    std::size_t mapped_ = 0;
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+};
\ No newline at end of file
@@ -1,14 +1,384 @@
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+#include "crawl.h"
+#include "frequency.h"
+#include "hll.h"
+#include "index.h"
+#include "input.h"
+#include "ngram.h"
+#include "parallel.h"
+#include "scan.h"
+#include "tokenize.h"
+#include "tokens.h"
+#include "utf8.h"
 #include "word.h"
 
+WordCountSnapshot count_input(const std::string& path, unsigned threads){
+    if (threads != 1 && path != "-" && std::filesystem::is_regular_file(path)){
+        MappedFile file(path);
+        ParallelCounts counts = count_parallel(file.data(), file.size(), threads);
+        WordCountSnapshot totals;
+        totals.words = counts.words;
+        totals.bytes = file.size();
+        totals.chars = fold_word_histogram(counts.chars);
+        return totals;
+    }
 
-int main(){
-    std::string text = "Hellow, World! C++ is amazing and very powerful.";
-    std::cout << "Word count: " << count_words(text) << std::endl;
-    auto result = count_char(text);
+    WordCounter counter;
+    for_each_chunk(path, kDefaultChunkSize, [&](const char* data, std::size_t size){
+        counter.feed(std::string_view(data, size));
+    });
+    return counter.snapshot();
+}
 
-    for (const auto& [ch, count] : result){
-        std::cout << ch << " : " << count << " | " ;
+void print_totals(const WordCountSnapshot& totals){
+    std::cout << "Word count: " << totals.words << std::endl;
+    for (int b = 0; b < 256; ++b){
+        if (totals.chars[b] != 0){
+            std::cout << static_cast<char>(b) << " : " << totals.chars[b] << " | ";
+        }
     }
     std::cout << std::endl;
+}
+
+void print_utf8_counts(const std::string& path){
+    Utf8Counter counter;
+    for_each_chunk(path, kDefaultChunkSize, [&](const char* data, std::size_t size){
+        counter.feed(data, size);
+    });
+    const Utf8Counts counts = counter.finish();
+
+    std::cout << "Word count: " << counts.words << std::endl;
+    std::cout << "Letters: " << counts.letters << ", Digits: " << counts.digits
+              << ", Code points: " << counts.code_points
+              << ", Invalid bytes: " << counts.invalid << std::endl;
+    std::string line;
+    for (const auto& [cp, count] : counts.chars){
+        append_utf8(line, cp);
+        line += " : " + std::to_string(count) + " | ";
+    }
+    std::cout << line << std::endl;
+}
+
+// Prints the k most frequent words. With bounded > 0 a Space-Saving sketch of
+// that many counters is used instead of an exact table, and each count is
+// followed by its maximum overestimate.
+void print_top_words(const std::string& path, std::size_t k, std::size_t bounded){
+    WordSplitter splitter;
+    if (bounded == 0){
+        FrequencyTable table;
+        auto add = [&](std::string_view word){ table.add(word); };
+        for_each_chunk(path, kDefaultChunkSize, [&](const char* data, std::size_t size){
+            splitter.feed(data, size, add);
+        });
+        splitter.finish(add);
+        for (const auto& wc : table.top_k(k)){
+            std::cout << wc.word << " : " << wc.count << std::endl;
+        }
+        return;
+    }
+
+    HeavyHitters sketch(bounded);
+    auto add = [&](std::string_view word){ sketch.add(word); };
+    for_each_chunk(path, kDefaultChunkSize, [&](const char* data, std::size_t size){
+        splitter.feed(data, size, add);
+    });
+    splitter.finish(add);
+    for (const auto& entry : sketch.top_k(k)){
+        std::cout << entry.word << " : " << entry.count << " (+/- " << entry.error << ")" << std::endl;
+    }
+}
+
+HyperLogLog sketch_input(const std::string& path, unsigned precision, unsigned threads){
+    if (threads != 1 && path != "-" && std::filesystem::is_regular_file(path)){
+        MappedFile file(path);
+        return sketch_distinct_words(file.data(), file.size(), precision, threads);
+    }
+    HyperLogLog sketch(precision);
+    WordSplitter splitter;
+    auto add = [&](std::string_view word){ sketch.add(word); };
+    for_each_chunk(path, kDefaultChunkSize, [&](const char* data, std::size_t size){
+        splitter.feed(data, size, add);
+    });
+    splitter.finish(add);
+    return sketch;
+}
+
+// The first n words at data, each preceded by a space. Only a window that
+// doubles until it holds n whole words is scanned, not the rest of the file.
+std::string first_words(const char* data, std::size_t size, unsigned n){
+    for (std::size_t window = 4096;; window *= 2){
+        const std::size_t length = std::min(window, size);
+        std::string text;
+        unsigned words = 0;
+        bool complete = false;
+        for_each_word(data, length, [&](std::string_view word){
+            if (words < n){
+                text += ' ';
+                text.append(word);
+            }
+            // A word touching the window's end may continue past it.
+            if (++words == n){
+                complete = word.data() + word.size() < data + length;
+            }
+        });
+        if (complete || words > n || length == size){
+            return text;
+        }
+    }
+}
+
+// Prints the most frequent word n-grams. The counter only keeps hashes and
+// offsets, so the words are read back from the file when it can be mapped.
+void print_top_ngrams(const std::string& path, unsigned n, std::size_t k, std::size_t memory_budget){
+    NgramCounter counter(n, memory_budget);
+    for_each_chunk(path, kDefaultChunkSize, [&](const char* data, std::size_t size){
+        counter.feed(data, size);
+    });
+    counter.finish();
+    const std::vector<NgramCount> top = counter.top_k(k);
+
+    std::unique_ptr<MappedFile> file;
+    if (path != "-" && std::filesystem::is_regular_file(path)){
+        file = std::make_unique<MappedFile>(path);
+    }
+    for (const auto& gram : top){
+        std::cout << gram.count << " :";
+        if (file){
+            std::cout << first_words(file->data() + gram.first_offset, file->size() - gram.first_offset, n);
+        } else {
+            std::cout << " #" << std::hex << gram.key << std::dec;
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "N-grams: " << counter.total() << ", Spilled runs: " << counter.spilled_runs() << std::endl;
+}
+
+// wc-style "lines words chars bytes longest-line" from one pass.
+void print_text_stats(const std::string& path){
+    TextStats stats;
+    for_each_chunk(path, kDefaultChunkSize, [&](const char* data, std::size_t size){
+        scan_text_stats(data, size, stats);
+    });
+    std::cout << "Lines: " << stats.lines << ", Words: " << stats.words
+              << ", Chars: " << stats.chars << ", Bytes: " << stats.bytes
+              << ", Longest line: " << stats.max_line_length << std::endl;
+}
+
+// wc-style listing: words, word characters and bytes per file, then a total.
+int print_tree_counts(const std::vector<std::string>& roots, unsigned threads){
+    CrawlOptions options;
+    options.threads = threads;
+    const std::vector<FileTotals> files = count_tree(roots, options);
+
+    int status = 0;
+    FileTotals total;
+    total.path = "total";
+    auto print_row = [](const FileTotals& row){
+        std::cout << std::setw(12) << row.words << std::setw(12) << row.chars
+                  << std::setw(14) << row.bytes << " " << row.path << std::endl;
+    };
+    for (const auto& file : files){
+        if (!file.error.empty()){
+            std::cerr << "Error: " << file.path << ": " << file.error << std::endl;
+            status = 1;
+            continue;
+        }
+        print_row(file);
+        total.words += file.words;
+        total.chars += file.chars;
+        total.bytes += file.bytes;
+    }
+    print_row(total);
+    return status;
+}
+
+// Parses the whole of text as an unsigned decimal number. Returns false,
+// rather than throwing or stopping at the first bad character, if it is not
+// one or does not fit.
+template <class Number>
+bool parse_number(const char* text, Number& value){
+    const char* end = text + std::strlen(text);
+    const auto result = std::from_chars(text, end, value);
+    return text != end && result.ec == std::errc() && result.ptr == end;
+}
+
+int main(int argc, char* argv[]){
+    // Usage: main [-j THREADS] [-r] [--stats] [--utf8] [--top K [--bounded N]]
+    //             [--ngrams N [--memory MB]] [--distinct [--precision P]]
+    //             [--index OUT] [--tokens OUT] [FILE...]
+    // "-" or no FILE reads standard input. -j 0 uses every hardware thread;
+    // the default is a single thread. --utf8 counts Unicode letters and
+    // digits instead of ASCII bytes. --top prints the K most frequent words
+    // instead of the totals; --bounded caps the tracked words at N. -r walks
+    // directories (default ".") and prints per-file and total counts.
+    // --stats prints line, word, character and byte counts plus the longest
+    // line. --ngrams lists the most frequent N-word sequences (--top K of
+    // them, default 20), spilling to temporary files beyond --memory MB
+    // (default 256).
+    // --distinct estimates the number of distinct words per file and across
+    // all files with a HyperLogLog sketch of 2^P registers (P from 4 to 18,
+    // default 12).
+    // --index writes an inverted index of the files (and directories) to OUT
+    // for the query tool. --tokens writes the words of all inputs as a
+    // dense vocabulary (OUT.vocab) and a binary token-id stream (OUT.ids).
+    unsigned threads = 1;
+    std::size_t top = 0;
+    std::size_t bounded = 0;
+    bool utf8 = false;
+    bool recursive = false;
+    bool stats = false;
+    unsigned ngrams = 0;
+    std::size_t memory_mb = 256;
+    bool distinct = false;
+    unsigned precision = 12;
+    std::string index_path;
+    std::string tokens_path;
+    std::vector<std::string> paths;
+    auto usage = [&](){
+        std::cerr << "Usage: " << argv[0] << " [-j THREADS] [-r] [--stats] [--utf8] [--top K [--bounded N]]\n"
+                  << "            [--ngrams N [--memory MB]] [--distinct [--precision P]]\n"
+                  << "            [--index OUT] [--tokens OUT] [FILE...]" << std::endl;
+        return 1;
+    };
+    for (int i = 1; i < argc; ++i){
+        std::string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc){
+            if (!parse_number(argv[++i], threads)){
+                return usage();
+            }
+        } else if (arg == "-r"){
+            recursive = true;
+        } else if (arg == "--ngrams" && i + 1 < argc){
+            if (!parse_number(argv[++i], ngrams) || ngrams == 0){
+                return usage();
+            }
+        } else if (arg == "--memory" && i + 1 < argc){
+            if (!parse_number(argv[++i], memory_mb) || memory_mb == 0 || memory_mb > (SIZE_MAX >> 20)){
+                return usage();
+            }
+        } else if (arg == "--distinct"){
+            distinct = true;
+        } else if (arg == "--precision" && i + 1 < argc){
+            if (!parse_number(argv[++i], precision) || precision < HyperLogLog::kMinPrecision
+                || precision > HyperLogLog::kMaxPrecision){
+                return usage();
+            }
+        } else if (arg == "--index" && i + 1 < argc){
+            index_path = argv[++i];
+        } else if (arg == "--tokens" && i + 1 < argc){
+            tokens_path = argv[++i];
+        } else if (arg == "--stats"){
+            stats = true;
+        } else if (arg == "--utf8"){
+            utf8 = true;
+        } else if (arg == "--top" && i + 1 < argc){
+            if (!parse_number(argv[++i], top) || top == 0){
+                return usage();
+            }
+        } else if (arg == "--bounded" && i + 1 < argc){
+            if (!parse_number(argv[++i], bounded) || bounded == 0){
+                return usage();
+            }
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.empty()){
+        paths.push_back(recursive ? "." : "-");
+    }
+
+    if (recursive){
+        try {
+            return print_tree_counts(paths, threads);
+        } catch (const std::exception& e){
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (!index_path.empty()){
+        std::vector<std::string> errors;
+        try {
+            const std::size_t files = build_index(paths, index_path, errors);
+            std::cout << "Indexed " << files << " file(s) into " << index_path << std::endl;
+        } catch (const std::exception& e){
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        for (const auto& error : errors){
+            std::cerr << "Error: " << error << std::endl;
+        }
+        return errors.empty() ? 0 : 1;
+    }
+
+    if (!tokens_path.empty()){
+        try {
+            TokenStreamWriter writer(tokens_path);
+            for (const auto& path : paths){
+                for_each_chunk(path, kDefaultChunkSize, [&](const char* data, std::size_t size){
+                    writer.feed(data, size);
+                });
+                writer.end_document();
+            }
+            writer.close();
+            std::cout << "Tokens: " << writer.tokens() << ", Vocabulary: "
+                      << writer.vocabulary_size() << std::endl;
+        } catch (const std::exception& e){
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (distinct){
+        try {
+            HyperLogLog total(precision);
+            for (const auto& path : paths){
+                HyperLogLog sketch = sketch_input(path, precision, threads);
+                std::cout << "Distinct words (approx.): " << sketch.estimate() << " " << path << std::endl;
+                total.merge(sketch);
+            }
+            if (paths.size() > 1){
+                std::cout << "Distinct words (approx.): " << total.estimate() << " total" << std::endl;
+            }
+        } catch (const std::exception& e){
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    int status = 0;
+    for (const auto& path : paths){
+        try {
+            if (paths.size() > 1){
+                std::cout << path << ":" << std::endl;
+            }
+            if (ngrams > 0){
+                print_top_ngrams(path, ngrams, top > 0 ? top : 20, memory_mb << 20);
+            } else if (top > 0){
+                print_top_words(path, top, bounded);
+            } else if (stats){
+                print_text_stats(path);
+            } else if (utf8){
+                print_utf8_counts(path);
+            } else {
+                print_totals(count_input(path, threads));
+            }
+        } catch (const std::exception& e){
+            std::cerr << "Error: " << e.what() << std::endl;
+            status = 1;
+        }
+    }
+    return status;
 }
\ No newline at end of file
@@ -0,0 +1,322 @@
+#include "ngram.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include "hash.h"
+#include "scan.h"
+
+#include <unistd.h>
+
+namespace {
+
+constexpr std::uint64_t kFnvOffset = 0xcbf29ce484222325ULL;
+constexpr std::uint64_t kFnvPrime = 0x100000001b3ULL;
+constexpr std::uint64_t kBase = 0x9e3779b97f4a7c15ULL;   // odd, so invertible mod 2^64
+
+// Largest power of two not above limit (at least 16).
+std::size_t floor_pow2(std::size_t limit){
+    std::size_t size = 16;
+    while (size * 2 <= limit){
+        size <<= 1;
+    }
+    return size;
+}
+
+// Sequential reader over one sorted run file.
+class RunReader {
+public:
+    explicit RunReader(const std::string& path){
+        in_.rdbuf()->pubsetbuf(buffer_, sizeof(buffer_));
+        in_.open(path, std::ios::binary);
+        if (!in_){
+            throw std::runtime_error("Could not open spill file: " + path);
+        }
+        advance();
+    }
+
+    bool done() const { return done_; }
+    const NgramCount& current() const { return current_; }
+
+    void advance(){
+        done_ = !in_.read(reinterpret_cast<char*>(&current_), sizeof(current_));
+    }
+
+private:
+    char buffer_[1 << 16];
+    std::ifstream in_;
+    NgramCount current_;
+    bool done_ = false;
+};
+
+bool key_less(const NgramCount& a, const NgramCount& b){
+    return a.key < b.key;
+}
+
+// Calls visit once per distinct key, with counts summed across memory and
+// every reader, walking all of them in key order. memory must be sorted.
+template <class Visit>
+void merge_sources(std::vector<std::unique_ptr<RunReader>>& readers,
+                   const std::vector<NgramCount>& memory, Visit&& visit){
+    // Heap entries are (key, source); source == readers.size() is memory.
+    using Head = std::pair<std::uint64_t, std::size_t>;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+    for (std::size_t r = 0; r < readers.size(); ++r){
+        if (!readers[r]->done()){
+            heads.emplace(readers[r]->current().key, r);
+        }
+    }
+    std::size_t next_memory = 0;
+    if (next_memory < memory.size()){
+        heads.emplace(memory[0].key, readers.size());
+    }
+
+    while (!heads.empty()){
+        NgramCount merged{heads.top().first, 0, ~std::uint64_t{0}};
+        while (!heads.empty() && heads.top().first == merged.key){
+            const std::size_t source = heads.top().second;
+            heads.pop();
+            const NgramCount& item = source == readers.size()
+                ? memory[next_memory] : readers[source]->current();
+            merged.count += item.count;
+            merged.first_offset = std::min(merged.first_offset, item.first_offset);
+            if (source == readers.size()){
+                if (++next_memory < memory.size()){
+                    heads.emplace(memory[next_memory].key, source);
+                }
+            } else {
+                readers[source]->advance();
+                if (!readers[source]->done()){
+                    heads.emplace(readers[source]->current().key, source);
+                }
+            }
+        }
+        visit(merged);
+    }
+}
+
+} // namespace
+
+NgramCounter::NgramCounter(unsigned n, std::size_t memory_budget, std::string spill_dir)
+    : n_(std::max(1u, n)),
+      spill_dir_(spill_dir.empty() ? std::filesystem::temp_directory_path().string() : std::move(spill_dir)),
+      window_(n_, 0),
+      window_start_(n_, 0){
+    // The table may double up to the largest power of two that fits the
+    // budget; it spills once that table is 70% full.
+    const std::size_t max_slots = floor_pow2(memory_budget / sizeof(Slot));
+    max_entries_ = max_slots * 7 / 10;
+    slots_.assign(std::min<std::size_t>(max_slots, 4096), Slot{0, 0, 0});
+    for (unsigned i = 1; i < n_; ++i){
+        drop_factor_ *= kBase;
+    }
+}
+
+NgramCounter::~NgramCounter(){
+    for (const auto& run : runs_){
+        std::error_code ec;
+        std::filesystem::remove(run, ec);
+    }
+}
+
+void NgramCounter::feed(const char* data, std::size_t size){
+    const auto* p = reinterpret_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i){
+        if (is_word_byte(p[i])){
+            if (!in_word_){
+                in_word_ = true;
+                token_hash_ = kFnvOffset;
+                token_start_ = offset_ + i;
+            }
+            token_hash_ = (token_hash_ ^ p[i]) * kFnvPrime;
+        } else if (in_word_){
+            in_word_ = false;
+            end_token();
+        }
+    }
+    offset_ += size;
+}
+
+void NgramCounter::finish(){
+    if (in_word_){
+        in_word_ = false;
+        end_token();
+    }
+}
+
+void NgramCounter::end_token(){
+    const std::uint64_t token = mix64(token_hash_);
+    const std::size_t slot = tokens_ % n_;
+    if (tokens_ >= n_){
+        rolling_ -= window_[slot] * drop_factor_;
+    }
+    rolling_ = rolling_ * kBase + token;
+    window_[slot] = token;
+    window_start_[slot] = token_start_;
+    ++tokens_;
+    if (tokens_ >= n_){
+        // The oldest token in the window is the one written next.
+        add(mix64(rolling_), window_start_[tokens_ % n_]);
+    }
+}
+
+void NgramCounter::add(std::uint64_t key, std::uint64_t offset){
+    ++total_;
+    std::size_t mask = slots_.size() - 1;
+    for (std::size_t i = key & mask;; i = (i + 1) & mask){
+        Slot& slot = slots_[i];
+        if (slot.count == 0){
+            break;
+        }
+        if (slot.key == key){
+            ++slot.count;
+            return;
+        }
+    }
+
+    if (size_ >= max_entries_){
+        spill();
+    } else if ((size_ + 1) * 10 > slots_.size() * 7){
+        std::vector<Slot> old(slots_.size() * 2, Slot{0, 0, 0});
+        old.swap(slots_);
+        mask = slots_.size() - 1;
+        for (const Slot& s : old){
+            if (s.count != 0){
+                std::size_t j = s.key & mask;
+                while (slots_[j].count != 0){
+                    j = (j + 1) & mask;
+                }
+                slots_[j] = s;
+            }
+        }
+    }
+    mask = slots_.size() - 1;
+    std::size_t i = key & mask;
+    while (slots_[i].count != 0){
+        i = (i + 1) & mask;
+    }
+    slots_[i] = Slot{key, 1, offset};
+    ++size_;
+}
+
+void NgramCounter::spill(){
+    std::vector<NgramCount> run;
+    run.reserve(size_);
+    for (const Slot& s : slots_){
+        if (s.count != 0){
+            run.push_back(NgramCount{s.key, s.count, s.first_offset});
+        }
+    }
+    std::sort(run.begin(), run.end(), key_less);
+
+    const std::string path = run_path();
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(run.data()),
+              static_cast<std::streamsize>(run.size() * sizeof(NgramCount)));
+    if (!out){
+        throw std::runtime_error("Could not write spill file: " + path);
+    }
+    runs_.push_back(path);
+    ++spilled_;
+
+    std::fill(slots_.begin(), slots_.end(), Slot{0, 0, 0});
+    size_ = 0;
+}
+
+// Unique per process and counter, so concurrent runs can share spill_dir.
+std::string NgramCounter::run_path(){
+    return (std::filesystem::path(spill_dir_)
+        / ("ngram-" + std::to_string(::getpid()) + "-" + std::to_string(reinterpret_cast<std::uintptr_t>(this))
+           + "-" + std::to_string(next_run_++) + ".run")).string();
+}
+
+// Merges groups of kMaxMergeFanIn runs into single runs until at most that
+// many are left.
+void NgramCounter::compact_runs(){
+    while (runs_.size() > kMaxMergeFanIn){
+        std::vector<std::string> merged_runs;
+        for (std::size_t first = 0; first < runs_.size(); first += kMaxMergeFanIn){
+            const std::size_t last = std::min(first + kMaxMergeFanIn, runs_.size());
+            if (last - first == 1){
+                merged_runs.push_back(runs_[first]);
+                continue;
+            }
+            const std::string path = run_path();
+            {
+                std::vector<std::unique_ptr<RunReader>> readers;
+                for (std::size_t r = first; r < last; ++r){
+                    readers.push_back(std::make_unique<RunReader>(runs_[r]));
+                }
+                std::ofstream out(path, std::ios::binary | std::ios::trunc);
+                merge_sources(readers, {}, [&](const NgramCount& item){
+                    out.write(reinterpret_cast<const char*>(&item), sizeof(item));
+                });
+                out.close();
+                if (!out){
+                    std::error_code ec;
+                    std::filesystem::remove(path, ec);
+                    throw std::runtime_error("Could not write spill file: " + path);
+                }
+            }
+            for (std::size_t r = first; r < last; ++r){
+                std::error_code ec;
+                std::filesystem::remove(runs_[r], ec);
+            }
+            merged_runs.push_back(path);
+        }
+        runs_.swap(merged_runs);
+    }
+}
+
+// Calls visit once per distinct key, with counts summed across the in-memory
+// table and every run, walking all of them in key order.
+template <class Visit>
+void NgramCounter::merge(Visit&& visit){
+    compact_runs();
+    std::vector<NgramCount> memory;
+    memory.reserve(size_);
+    for (const Slot& s : slots_){
+        if (s.count != 0){
+            memory.push_back(NgramCount{s.key, s.count, s.first_offset});
+        }
+    }
+    std::sort(memory.begin(), memory.end(), key_less);
+
+    std::vector<std::unique_ptr<RunReader>> readers;
+    for (const auto& run : runs_){
+        readers.push_back(std::make_unique<RunReader>(run));
+    }
+    merge_sources(readers, memory, visit);
+}
+
+std::vector<NgramCount> NgramCounter::top_k(std::size_t k){
+    auto ranks_before = [](const NgramCount& a, const NgramCount& b){
+        return a.count != b.count ? a.count > b.count : a.first_offset < b.first_offset;
+    };
+    std::priority_queue<NgramCount, std::vector<NgramCount>, decltype(ranks_before)> heap(ranks_before);
+    if (k == 0){
+        return {};
+    }
+    merge([&](const NgramCount& item){
+        if (heap.size() < k){
+            heap.push(item);
+        } else if (ranks_before(item, heap.top())){
+            heap.pop();
+            heap.push(item);
+        }
+    });
+    std::vector<NgramCount> result(heap.size());
+    for (auto it = result.rbegin(); it != result.rend(); ++it){
+        *it = heap.top();
+        heap.pop();
+    }
+    return result;
+}
+
+std::uint64_t NgramCounter::distinct(){
+    std::uint64_t count = 0;
+    merge([&](const NgramCount&){ ++count; });
+    return count;
+}
\ No newline at end of file
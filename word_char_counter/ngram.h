@@ -0,0 +1,81 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct NgramCount {
+    std::uint64_t key = 0;           // rolling hash of the n token hashes
+    std::uint64_t count = 0;
+    std::uint64_t first_offset = 0;  // byte offset of the first occurrence's first token
+};
+
+// Counts word n-grams over a stream fed in arbitrary pieces. Tokens follow
+// the count_words rule and are hashed byte by byte as they are scanned, and
+// the n-gram key is a polynomial rolling hash over the last n token hashes,
+// so no token or n-gram string is ever materialised. Keys are 64-bit, so
+// distinct n-grams collide with negligible probability.
+//
+// Counts live in a flat open-addressing table. When it would exceed
+// memory_budget bytes it is sorted by key and written to a run file in
+// spill_dir; top_k() merges all runs with the in-memory table. Runs are
+// merged kMaxMergeFanIn at a time, in as many passes as needed, so the number
+// of open files stays bounded however many runs there are.
+class NgramCounter {
+public:
+    NgramCounter(unsigned n, std::size_t memory_budget, std::string spill_dir = {});
+    ~NgramCounter();
+    NgramCounter(const NgramCounter&) = delete;
+    NgramCounter& operator=(const NgramCounter&) = delete;
+
+    void feed(const char* data, std::size_t size);
+    void finish();
+
+    // The k most frequent n-grams, most frequent first (ties by offset).
+    std::vector<NgramCount> top_k(std::size_t k);
+
+    std::uint64_t total() const { return total_; }
+    std::uint64_t distinct();
+    std::size_t spilled_runs() const { return spilled_; }
+
+    static constexpr std::size_t kMaxMergeFanIn = 32;
+
+private:
+    struct Slot {
+        std::uint64_t key;
+        std::uint64_t count;   // 0 marks an empty slot
+        std::uint64_t first_offset;
+    };
+
+    void end_token();
+    void add(std::uint64_t key, std::uint64_t offset);
+    void spill();
+    std::string run_path();
+    void compact_runs();
+    template <class Visit>
+    void merge(Visit&& visit);
+
+    unsigned n_;
+    std::size_t max_entries_;
+    std::string spill_dir_;
+    std::vector<std::string> runs_;
+    std::size_t spilled_ = 0;
+    std::size_t next_run_ = 0;
+
+    std::vector<Slot> slots_;
+    std::size_t size_ = 0;
+    std::uint64_t total_ = 0;
+
+    // Rolling state.
+    std::vector<std::uint64_t> window_;        // ring of the last n token hashes
+    std::vector<std::uint64_t> window_start_;  // and their start offsets
+    std::size_t tokens_ = 0;
+    std::uint64_t rolling_ = 0;
+    std::uint64_t drop_factor_ = 1;            // kBase^(n-1)
+
+    // Token being scanned.
+    bool in_word_ = false;
+    std::uint64_t token_hash_ = 0;
+    std::uint64_t token_start_ = 0;
+    std::uint64_t offset_ = 0;
+};
\ No newline at end of file
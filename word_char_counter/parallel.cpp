@@ -0,0 +1,48 @@
+#include "parallel.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Below this much work per thread, starting the thread costs more than it saves.
+constexpr std::size_t kMinBytesPerThread = std::size_t{1} << 20;
+
+} // namespace
+
+ParallelCounts
+count_parallel(const char* data, std::size_t size, unsigned threads){
+    if (threads == 0){
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const std::size_t useful = std::max<std::size_t>(1, size / kMinBytesPerThread);
+    const auto workers = static_cast<unsigned>(std::min<std::size_t>(threads, useful));
+
+    std::vector<ParallelCounts> partial(workers);
+    auto scan_range = [&](unsigned t){
+        const std::size_t begin = size * t / workers;
+        const std::size_t end = size * (t + 1) / workers;
+        bool in_word = begin > 0 && is_word_byte(static_cast<unsigned char>(data[begin - 1]));
+        partial[t].words = count_word_starts(data + begin, end - begin, in_word);
+        accumulate_histogram(data + begin, end - begin, partial[t].chars);
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (unsigned t = 1; t < workers; ++t){
+        pool.emplace_back(scan_range, t);
+    }
+    scan_range(0);
+    for (auto& th : pool){
+        th.join();
+    }
+
+    ParallelCounts total;
+    for (const auto& p : partial){
+        total.words += p.words;
+        for (int b = 0; b < 256; ++b){
+            total.chars[b] += p.chars[b];
+        }
+    }
+    return total;
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "scan.h"
+
+struct ParallelCounts {
+    std::uint64_t words = 0;
+    ByteHistogram chars{};   // raw byte counts, see fold_word_histogram
+};
+
+// Splits [data, data + size) into one contiguous range per thread, scans the
+// ranges concurrently and merges the results. A range that begins inside a
+// word looks at the byte before it, so the word is counted exactly once and
+// the result is identical to a serial scan. threads == 0 means one per
+// hardware thread; small inputs use fewer threads than requested.
+ParallelCounts
+count_parallel(const char* data, std::size_t size, unsigned threads = 0);
\ No newline at end of file
@@ -0,0 +1,40 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "index.h"
+
+int main(int argc, char* argv[]){
+    // Usage: query INDEX TERM...
+    // Lists the files containing every TERM, with the count of each term.
+    if (argc < 3){
+        std::cerr << "Usage: " << argv[0] << " INDEX TERM..." << std::endl;
+        return 1;
+    }
+    try {
+        const auto start = std::chrono::steady_clock::now();
+        IndexReader index(argv[1]);
+        const auto opened = std::chrono::steady_clock::now();
+
+        std::vector<std::string> terms(argv + 2, argv + argc);
+        std::vector<std::vector<std::uint64_t>> counts;
+        const std::vector<std::uint32_t> files = index.lookup_all(terms, counts);
+        const auto done = std::chrono::steady_clock::now();
+
+        for (std::size_t i = 0; i < files.size(); ++i){
+            std::cout << index.file_path(files[i]) << ":";
+            for (std::size_t t = 0; t < terms.size(); ++t){
+                std::cout << " " << terms[t] << "=" << counts[i][t];
+            }
+            std::cout << std::endl;
+        }
+        using us = std::chrono::microseconds;
+        std::cerr << files.size() << " file(s); open "
+                  << std::chrono::duration_cast<us>(opened - start).count() << " us, query "
+                  << std::chrono::duration_cast<us>(done - opened).count() << " us" << std::endl;
+    } catch (const std::exception& e){
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
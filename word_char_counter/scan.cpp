@@ -0,0 +1,280 @@
+#include "scan.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+std::uint64_t
+count_word_starts_scalar(const unsigned char* p, std::size_t size, bool& prev_in_word){
+    std::uint64_t starts = 0;
+    bool prev = prev_in_word;
+    for (std::size_t i = 0; i < size; ++i){
+        bool cur = is_word_byte(p[i]);
+        starts += cur & !prev;
+        prev = cur;
+    }
+    prev_in_word = prev;
+    return starts;
+}
+
+#if defined(__AVX2__)
+
+// Unsigned "lo <= x <= hi" per byte, using the signed compare with a bias.
+inline __m256i in_range(__m256i x, char lo, char hi){
+    const __m256i shifted = _mm256_add_epi8(x, _mm256_set1_epi8(static_cast<char>(0x80 - lo)));
+    const __m256i limit = _mm256_set1_epi8(static_cast<char>(0x80 + (hi - lo) + 1));
+    return _mm256_cmpgt_epi8(limit, shifted);
+}
+
+inline std::uint32_t word_mask(const unsigned char* p){
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    const __m256i folded = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    const __m256i word = _mm256_or_si256(in_range(v, '0', '9'), in_range(folded, 'a', 'z'));
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(word));
+}
+
+// Word bytes, '\n' bytes and bytes that start a UTF-8 character (anything
+// but a 10xxxxxx continuation byte) from a single load.
+inline void line_masks(const unsigned char* p, std::uint32_t& word,
+                       std::uint32_t& newline, std::uint32_t& lead){
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    const __m256i folded = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    word = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+        _mm256_or_si256(in_range(v, '0', '9'), in_range(folded, 'a', 'z'))));
+    newline = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))));
+    lead = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+        _mm256_cmpgt_epi8(v, _mm256_set1_epi8(static_cast<char>(0xBF)))));
+}
+
+// Membership of each byte in words, as a bit mask. The low nibble picks a
+// row of each half-table, the high nibble picks the half and the bit.
+inline std::uint32_t class_mask(const unsigned char* p, __m256i low_half, __m256i high_half){
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i lo = _mm256_and_si256(v, nibble);
+    const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+    const __m256i bits = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+                                          1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m256i upper = _mm256_cmpgt_epi8(hi, _mm256_set1_epi8(7));
+    const __m256i row = _mm256_blendv_epi8(_mm256_shuffle_epi8(low_half, lo),
+                                           _mm256_shuffle_epi8(high_half, lo), upper);
+    const __m256i miss = _mm256_cmpeq_epi8(_mm256_and_si256(row, _mm256_shuffle_epi8(bits, hi)),
+                                           _mm256_setzero_si256());
+    return ~static_cast<std::uint32_t>(_mm256_movemask_epi8(miss));
+}
+
+inline __m256i load_half_table(const std::array<std::uint8_t, 16>& table){
+    return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table.data())));
+}
+
+constexpr std::size_t kBlock = 32;
+
+#elif defined(__SSE2__)
+
+inline __m128i in_range(__m128i x, char lo, char hi){
+    const __m128i shifted = _mm_add_epi8(x, _mm_set1_epi8(static_cast<char>(0x80 - lo)));
+    const __m128i limit = _mm_set1_epi8(static_cast<char>(0x80 + (hi - lo) + 1));
+    return _mm_cmpgt_epi8(limit, shifted);
+}
+
+inline std::uint32_t word_mask(const unsigned char* p){
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const __m128i folded = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    const __m128i word = _mm_or_si128(in_range(v, '0', '9'), in_range(folded, 'a', 'z'));
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(word));
+}
+
+inline void line_masks(const unsigned char* p, std::uint32_t& word,
+                       std::uint32_t& newline, std::uint32_t& lead){
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const __m128i folded = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    word = static_cast<std::uint32_t>(_mm_movemask_epi8(
+        _mm_or_si128(in_range(v, '0', '9'), in_range(folded, 'a', 'z'))));
+    newline = static_cast<std::uint32_t>(_mm_movemask_epi8(
+        _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))));
+    lead = static_cast<std::uint32_t>(_mm_movemask_epi8(
+        _mm_cmpgt_epi8(v, _mm_set1_epi8(static_cast<char>(0xBF)))));
+}
+
+#if defined(__SSSE3__)
+inline std::uint32_t class_mask(const unsigned char* p, __m128i low_half, __m128i high_half){
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i lo = _mm_and_si128(v, nibble);
+    const __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), nibble);
+    const __m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m128i upper = _mm_cmpgt_epi8(hi, _mm_set1_epi8(7));
+    const __m128i row = _mm_or_si128(_mm_and_si128(upper, _mm_shuffle_epi8(high_half, lo)),
+                                     _mm_andnot_si128(upper, _mm_shuffle_epi8(low_half, lo)));
+    const __m128i miss = _mm_cmpeq_epi8(_mm_and_si128(row, _mm_shuffle_epi8(bits, hi)),
+                                        _mm_setzero_si128());
+    return ~static_cast<std::uint32_t>(_mm_movemask_epi8(miss)) & 0xFFFFu;
+}
+
+inline __m128i load_half_table(const std::array<std::uint8_t, 16>& table){
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(table.data()));
+}
+#endif
+
+constexpr std::size_t kBlock = 16;
+
+#endif
+
+} // namespace
+
+std::uint64_t
+count_word_starts(const char* data, std::size_t size, bool& prev_in_word){
+    const auto* p = reinterpret_cast<const unsigned char*>(data);
+    std::uint64_t starts = 0;
+    std::size_t i = 0;
+#if defined(__AVX2__) || defined(__SSE2__)
+    // A word starts wherever bit i is set and bit i-1 is not; the carry feeds
+    // the last bit of the previous block into bit -1 of the next one.
+    std::uint32_t carry = prev_in_word ? 1u : 0u;
+    for (; i + kBlock <= size; i += kBlock){
+        const std::uint32_t mask = word_mask(p + i);
+        const std::uint32_t prev = (mask << 1) | carry;
+        starts += static_cast<std::uint64_t>(__builtin_popcount(mask & ~prev));
+        carry = (mask >> (kBlock - 1)) & 1u;
+    }
+    prev_in_word = carry != 0;
+#endif
+    starts += count_word_starts_scalar(p + i, size - i, prev_in_word);
+    return starts;
+}
+
+std::uint64_t
+count_word_starts(const char* data, std::size_t size, const NibbleClassifier& words,
+                  bool& prev_in_word){
+    const auto* p = reinterpret_cast<const unsigned char*>(data);
+    std::uint64_t starts = 0;
+    std::size_t i = 0;
+    bool prev = prev_in_word;
+#if defined(__AVX2__) || defined(__SSSE3__)
+    const auto low_half = load_half_table(words.low_half);
+    const auto high_half = load_half_table(words.high_half);
+    std::uint32_t carry = prev ? 1u : 0u;
+    for (; i + kBlock <= size; i += kBlock){
+        const std::uint32_t mask = class_mask(p + i, low_half, high_half);
+        starts += static_cast<std::uint64_t>(__builtin_popcount(mask & ~((mask << 1) | carry)));
+        carry = (mask >> (kBlock - 1)) & 1u;
+    }
+    prev = carry != 0;
+#endif
+    for (; i < size; ++i){
+        const bool cur = words.contains(p[i]);
+        starts += cur & !prev;
+        prev = cur;
+    }
+    prev_in_word = prev;
+    return starts;
+}
+
+void accumulate_histogram(const char* data, std::size_t size, ByteHistogram& hist){
+    const auto* p = reinterpret_cast<const unsigned char*>(data);
+    // Small inputs (e.g. lines fed to WordCounter one at a time) are not
+    // worth clearing and merging the sub-histograms for.
+    if (size < 1024){
+        for (std::size_t i = 0; i < size; ++i){
+            ++hist[p[i]];
+        }
+        return;
+    }
+    // Four sub-histograms so runs of the same byte do not serialise on a
+    // single counter's load/store chain.
+    std::uint32_t sub[4][256] = {};
+    while (size > 0){
+        // Flush before any 32-bit sub-counter could overflow.
+        const std::size_t n = size < (std::size_t{1} << 30) ? size : (std::size_t{1} << 30);
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4){
+            ++sub[0][p[i]];
+            ++sub[1][p[i + 1]];
+            ++sub[2][p[i + 2]];
+            ++sub[3][p[i + 3]];
+        }
+        for (; i < n; ++i){
+            ++sub[0][p[i]];
+        }
+        for (int b = 0; b < 256; ++b){
+            hist[b] += std::uint64_t{sub[0][b]} + sub[1][b] + sub[2][b] + sub[3][b];
+            sub[0][b] = sub[1][b] = sub[2][b] = sub[3][b] = 0;
+        }
+        p += n;
+        size -= n;
+    }
+}
+
+void scan_text_stats(const char* data, std::size_t size, TextStats& stats){
+    const auto* p = reinterpret_cast<const unsigned char*>(data);
+    std::size_t i = 0;
+    std::uint64_t line = stats.current_line;
+    std::uint64_t longest = stats.max_line_length;
+#if defined(__AVX2__) || defined(__SSE2__)
+    std::uint32_t carry = stats.in_word ? 1u : 0u;
+    for (; i + kBlock <= size; i += kBlock){
+        std::uint32_t word, newline, lead;
+        line_masks(p + i, word, newline, lead);
+        stats.words += static_cast<std::uint64_t>(__builtin_popcount(word & ~((word << 1) | carry)));
+        carry = (word >> (kBlock - 1)) & 1u;
+        stats.chars += static_cast<std::uint64_t>(__builtin_popcount(lead));
+
+        // Newlines are rare compared to other bytes, so walk them bit by bit
+        // and measure each line as the characters between two of them.
+        std::uint64_t from = 0;
+        while (newline != 0){
+            const unsigned pos = static_cast<unsigned>(__builtin_ctz(newline));
+            const std::uint64_t span = ((std::uint64_t{1} << pos) - 1) & ~((std::uint64_t{1} << from) - 1);
+            line += static_cast<std::uint64_t>(__builtin_popcountll(lead & span));
+            longest = line > longest ? line : longest;
+            line = 0;
+            ++stats.lines;
+            from = pos + 1;
+            newline &= newline - 1;
+        }
+        line += static_cast<std::uint64_t>(__builtin_popcountll(lead & ~((std::uint64_t{1} << from) - 1)));
+    }
+    stats.in_word = carry != 0;
+#endif
+    for (; i < size; ++i){
+        const unsigned char c = p[i];
+        const bool word = is_word_byte(c);
+        stats.words += word & !stats.in_word;
+        stats.in_word = word;
+        const bool is_lead = (c & 0xC0) != 0x80;
+        stats.chars += is_lead;
+        if (c == '\n'){
+            longest = line > longest ? line : longest;
+            line = 0;
+            ++stats.lines;
+        } else {
+            line += is_lead;
+        }
+    }
+    stats.bytes += size;
+    stats.current_line = line;
+    stats.max_line_length = line > longest ? line : longest;
+}
+
+ByteHistogram fold_word_histogram(const ByteHistogram& raw){
+    ByteHistogram folded{};
+    for (int b = 0; b < 256; ++b){
+        if (raw[b] != 0 && is_word_byte(static_cast<unsigned char>(b))){
+            folded[(b >= 'A' && b <= 'Z') ? (b | 0x20) : b] += raw[b];
+        }
+    }
+    return folded;
+}
+
+const char* scan_kernel_name(){
+#if defined(__AVX2__)
+    return "avx2";
+#elif defined(__SSE2__)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Raw byte counts, indexed by unsigned char value.
+using ByteHistogram = std::array<std::uint64_t, 256>;
+
+// Same rule as std::isalnum in the "C" locale: [0-9A-Za-z].
+constexpr bool is_word_byte(unsigned char c){
+    return (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z');
+}
+
+// Counts bytes that start a run of word bytes. prev_in_word says whether the
+// byte just before data was a word byte, so a scan can be resumed across
+// buffer boundaries; on return it holds the state after the last byte.
+std::uint64_t
+count_word_starts(const char* data, std::size_t size, bool& prev_in_word);
+
+// An arbitrary set of byte values as two 16-entry nibble tables, which the
+// SIMD kernels apply to a whole block with byte shuffles: c is in the set if
+// bit (c >> 4) of the mask for its low nibble is set. The 16-bit masks are
+// split in halves (high nibbles 0-7 and 8-15) so each fits a byte lane.
+struct NibbleClassifier {
+    std::array<std::uint8_t, 16> low_half{};
+    std::array<std::uint8_t, 16> high_half{};
+
+    constexpr bool contains(unsigned char c) const {
+        const unsigned hi = c >> 4;
+        const unsigned row = hi < 8 ? low_half[c & 15] : high_half[c & 15];
+        return ((row >> (hi & 7)) & 1) != 0;
+    }
+};
+
+// count_word_starts with words giving the word bytes instead of [0-9A-Za-z].
+std::uint64_t
+count_word_starts(const char* data, std::size_t size, const NibbleClassifier& words,
+                  bool& prev_in_word);
+
+// Adds the count of every byte value in data to hist.
+void accumulate_histogram(const char* data, std::size_t size, ByteHistogram& hist);
+
+struct TextStats {
+    std::uint64_t lines = 0;            // '\n' characters, as wc -l
+    std::uint64_t words = 0;            // same rule as count_words
+    std::uint64_t bytes = 0;
+    std::uint64_t chars = 0;            // UTF-8 characters (non-continuation bytes)
+    std::uint64_t max_line_length = 0;  // in characters, excluding the '\n'
+
+    // Carried between calls so a stream can be scanned in pieces.
+    bool in_word = false;
+    std::uint64_t current_line = 0;
+};
+
+// Adds the lines, words, bytes and characters of data to stats in a single
+// pass over the bytes: one load per block feeds every counter, so files far
+// larger than the cache are read from memory only once.
+void scan_text_stats(const char* data, std::size_t size, TextStats& stats);
+
+// Keeps only word bytes and merges upper-case letters into their lower-case
+// entries, which is how count_char reports characters.
+ByteHistogram fold_word_histogram(const ByteHistogram& raw);
+
+// Name of the classification path compiled in ("avx2", "sse2" or "scalar").
+const char* scan_kernel_name();
@@ -0,0 +1,119 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+namespace {
+
+// Index of the pool worker running on this thread, or -1 elsewhere.
+thread_local int t_worker_index = -1;
+thread_local const WorkStealingPool* t_worker_pool = nullptr;
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(unsigned threads){
+    if (threads == 0){
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 0; i < threads; ++i){
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    for (unsigned i = 0; i < threads; ++i){
+        workers_.emplace_back([this, i]{ run(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool(){
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        all_done_.wait(lock, [this]{ return unfinished_ == 0; });
+        stopping_ = true;
+    }
+    work_available_.notify_all();
+    for (auto& worker : workers_){
+        worker.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task){
+    unsigned target;
+    if (t_worker_pool == this){
+        target = static_cast<unsigned>(t_worker_index);
+    } else {
+        target = next_queue_.fetch_add(1, std::memory_order_relaxed) % size();
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues_[target]->mutex);
+        queues_[target]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++queued_;
+        ++unfinished_;
+    }
+    work_available_.notify_one();
+}
+
+bool WorkStealingPool::try_pop(unsigned self, Task& task){
+    {
+        Queue& own = *queues_[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()){
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (unsigned k = 1; k < size(); ++k){
+        Queue& victim = *queues_[(self + k) % size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()){
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::run(unsigned self){
+    t_worker_index = static_cast<int>(self);
+    t_worker_pool = this;
+    for (;;){
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_available_.wait(lock, [this]{ return queued_ > 0 || stopping_; });
+            if (queued_ == 0){
+                return;
+            }
+            // Claim one task; it is guaranteed to be in some deque.
+            --queued_;
+        }
+        Task task;
+        while (!try_pop(self, task)){
+            std::this_thread::yield();
+        }
+        try {
+            task();
+        } catch (...){
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_){
+                error_ = std::current_exception();
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--unfinished_ == 0){
+                all_done_.notify_all();
+            }
+        }
+    }
+}
+
+void WorkStealingPool::wait(){
+    std::unique_lock<std::mutex> lock(mutex_);
+    all_done_.wait(lock, [this]{ return unfinished_ == 0; });
+    if (error_){
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
\ No newline at end of file
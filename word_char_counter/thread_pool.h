@@ -0,0 +1,80 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads, each with its own task deque. A worker runs
+// its own tasks newest-first and, when it runs dry, steals the oldest task
+// from another worker, so uneven tasks (one huge file next to many small
+// ones) still keep every thread busy.
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    // threads == 0 means one per hardware thread.
+    explicit WorkStealingPool(unsigned threads = 0);
+    ~WorkStealingPool();
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Tasks submitted from a worker go to that worker's own deque.
+    void submit(Task task);
+
+    // Blocks until every submitted task has finished. Rethrows the first
+    // exception thrown by a task, if any.
+    void wait();
+
+    unsigned size() const { return static_cast<unsigned>(workers_.size()); }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool try_pop(unsigned self, Task& task);
+    void run(unsigned self);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::condition_variable all_done_;
+    std::size_t queued_ = 0;      // tasks sitting in a deque, guarded by mutex_
+    std::size_t unfinished_ = 0;  // submitted but not yet completed, guarded by mutex_
+    bool stopping_ = false;
+    std::exception_ptr error_;
+    std::atomic<unsigned> next_queue_{0};
+};
+
+// Counting semaphore (std::counting_semaphore needs C++20).
+class Semaphore {
+public:
+    explicit Semaphore(std::size_t count) : count_(count) {}
+
+    void acquire(){
+        std::unique_lock<std::mutex> lock(mutex_);
+        available_.wait(lock, [this]{ return count_ > 0; });
+        --count_;
+    }
+
+    void release(){
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++count_;
+        }
+        available_.notify_one();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable available_;
+    std::size_t count_;
+};
\ No newline at end of file
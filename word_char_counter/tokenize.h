@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "classify.h"
+
+// Calls on_word for every maximal run of word bytes in data, i.e. for each
+// word count_words<Policy> would count, in order.
+template <class Policy = AlnumPolicy, class OnWord>
+void for_each_word(const char* data, std::size_t size, OnWord&& on_word){
+    const auto* p = reinterpret_cast<const unsigned char*>(data);
+    std::size_t i = 0;
+    while (i < size){
+        while (i < size && !Policy::table[p[i]]){
+            ++i;
+        }
+        const std::size_t begin = i;
+        while (i < size && Policy::table[p[i]]){
+            ++i;
+        }
+        if (i > begin){
+            on_word(std::string_view(data + begin, i - begin));
+        }
+    }
+}
+
+// Splits a sequence of chunks into words, rejoining words cut by a chunk
+// boundary. The view passed to on_word is only valid during the call.
+template <class Policy = AlnumPolicy>
+class BasicWordSplitter {
+public:
+    template <class OnWord>
+    void feed(const char* data, std::size_t size, OnWord&& on_word){
+        std::size_t i = 0;
+        if (!partial_.empty()){
+            while (i < size && Policy::table[static_cast<unsigned char>(data[i])]){
+                ++i;
+            }
+            partial_.append(data, i);
+            if (i == size){
+                return;
+            }
+            on_word(std::string_view(partial_));
+            partial_.clear();
+        }
+        std::size_t tail = size;
+        while (tail > i && Policy::table[static_cast<unsigned char>(data[tail - 1])]){
+            --tail;
+        }
+        for_each_word<Policy>(data + i, tail - i, on_word);
+        partial_.assign(data + tail, size - tail);
+    }
+
+    template <class OnWord>
+    void finish(OnWord&& on_word){
+        if (!partial_.empty()){
+            on_word(std::string_view(partial_));
+            partial_.clear();
+        }
+    }
+
+private:
+    std::string partial_;
+};
+
+using WordSplitter = BasicWordSplitter<>;
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include "tokens.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+std::runtime_error io_error(const std::string& what, const std::string& path){
+    return std::runtime_error(what + " '" + path + "': " + std::strerror(errno));
+}
+
+void write_all(int fd, const void* data, std::size_t size, const std::string& path){
+    const char* p = static_cast<const char*>(data);
+    while (size > 0){
+        const ssize_t n = ::write(fd, p, size);
+        if (n < 0){
+            if (errno == EINTR){
+                continue;
+            }
+            throw io_error("Could not write", path);
+        }
+        p += n;
+        size -= static_cast<std::size_t>(n);
+    }
+}
+
+TokenStreamHeader make_header(const char (&magic)[8], std::uint64_t count){
+    TokenStreamHeader header{};
+    std::memcpy(header.magic, magic, sizeof(header.magic));
+    header.version = 1;
+    header.count = count;
+    return header;
+}
+
+std::uint32_t* allocate_buffer(){
+    void* p = std::aligned_alloc(4096, TokenStreamWriter::kBufferSize);
+    if (p == nullptr){
+        throw std::bad_alloc();
+    }
+    return static_cast<std::uint32_t*>(p);
+}
+
+} // namespace
+
+TokenStreamWriter::TokenStreamWriter(const std::string& path)
+    : path_(path), buffer_(allocate_buffer(), std::free){
+    const std::string ids_path = path_ + ".ids";
+    fd_ = ::open(ids_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0){
+        throw io_error("Could not create", ids_path);
+    }
+    // Placeholder; the real count is written by close().
+    const TokenStreamHeader header = make_header(kTokenIdsMagic, 0);
+    write_all(fd_, &header, sizeof(header), ids_path);
+}
+
+TokenStreamWriter::~TokenStreamWriter(){
+    if (fd_ >= 0){
+        try {
+            close();
+        } catch (...){
+            // Destructors must not throw; call close() to see errors.
+        }
+    }
+}
+
+void TokenStreamWriter::add(std::string_view word){
+    auto it = ids_.find(word);
+    if (it == ids_.end()){
+        const std::string_view stored = arena_.store(word);
+        it = ids_.emplace(stored, static_cast<std::uint32_t>(words_.size())).first;
+        words_.push_back(stored);
+    }
+    buffer_[buffered_++] = it->second;
+    ++tokens_;
+    if (buffered_ == kBufferSize / sizeof(std::uint32_t)){
+        flush();
+    }
+}
+
+void TokenStreamWriter::flush(){
+    write_all(fd_, buffer_.get(), buffered_ * sizeof(std::uint32_t), path_ + ".ids");
+    buffered_ = 0;
+}
+
+void TokenStreamWriter::feed(const char* data, std::size_t size){
+    splitter_.feed(data, size, [this](std::string_view word){ add(word); });
+}
+
+void TokenStreamWriter::end_document(){
+    splitter_.finish([this](std::string_view word){ add(word); });
+}
+
+void TokenStreamWriter::close(){
+    if (fd_ < 0){
+        return;
+    }
+    end_document();
+    flush();
+    const std::string ids_path = path_ + ".ids";
+    const TokenStreamHeader header = make_header(kTokenIdsMagic, tokens_);
+    if (::pwrite(fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))){
+        throw io_error("Could not write", ids_path);
+    }
+    const int fd = fd_;
+    fd_ = -1;
+    if (::close(fd) != 0){
+        throw io_error("Could not write", ids_path);
+    }
+
+    const std::string vocab_path = path_ + ".vocab";
+    const int vocab_fd = ::open(vocab_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (vocab_fd < 0){
+        throw io_error("Could not create", vocab_path);
+    }
+    std::vector<std::uint64_t> offsets;
+    offsets.reserve(words_.size() + 1);
+    std::uint64_t offset = 0;
+    for (std::string_view word : words_){
+        offsets.push_back(offset);
+        offset += word.size();
+    }
+    offsets.push_back(offset);
+    std::string bytes;
+    bytes.reserve(static_cast<std::size_t>(offset));
+    for (std::string_view word : words_){
+        bytes.append(word);
+    }
+    const TokenStreamHeader vocab_header = make_header(kVocabMagic, words_.size());
+    try {
+        write_all(vocab_fd, &vocab_header, sizeof(vocab_header), vocab_path);
+        write_all(vocab_fd, offsets.data(), offsets.size() * sizeof(std::uint64_t), vocab_path);
+        write_all(vocab_fd, bytes.data(), bytes.size(), vocab_path);
+    } catch (...){
+        ::close(vocab_fd);
+        throw;
+    }
+    if (::close(vocab_fd) != 0){
+        throw io_error("Could not write", vocab_path);
+    }
+}
+
+TokenStreamReader::TokenStreamReader(const std::string& path)
+    : ids_file_(path + ".ids"), vocab_file_(path + ".vocab"){
+    auto header_of = [&](const MappedFile& file, const char (&magic)[8], const std::string& name){
+        if (file.size() < sizeof(TokenStreamHeader)
+            || std::memcmp(file.data(), magic, sizeof(magic)) != 0){
+            throw std::runtime_error("Not a token stream file: " + name);
+        }
+        return reinterpret_cast<const TokenStreamHeader*>(file.data());
+    };
+
+    const TokenStreamHeader* ids = header_of(ids_file_, kTokenIdsMagic, path + ".ids");
+    if (ids->count > (ids_file_.size() - sizeof(TokenStreamHeader)) / sizeof(std::uint32_t)){
+        throw std::runtime_error("Truncated token stream: " + path + ".ids");
+    }
+    count_ = static_cast<std::size_t>(ids->count);
+    ids_ = reinterpret_cast<const std::uint32_t*>(ids_file_.data() + sizeof(TokenStreamHeader));
+
+    const TokenStreamHeader* vocab = header_of(vocab_file_, kVocabMagic, path + ".vocab");
+    const std::size_t body = vocab_file_.size() - sizeof(TokenStreamHeader);
+    if (vocab->count >= body / sizeof(std::uint64_t)){
+        throw std::runtime_error("Truncated vocabulary: " + path + ".vocab");
+    }
+    vocab_count_ = static_cast<std::size_t>(vocab->count);
+    offsets_ = reinterpret_cast<const std::uint64_t*>(vocab_file_.data() + sizeof(TokenStreamHeader));
+    bytes_ = reinterpret_cast<const char*>(offsets_ + vocab_count_ + 1);
+    bytes_size_ = body - (vocab_count_ + 1) * sizeof(std::uint64_t);
+    for (std::size_t i = 0; i < vocab_count_; ++i){
+        if (offsets_[i] > offsets_[i + 1]){
+            throw std::runtime_error("Corrupt vocabulary offsets: " + path + ".vocab");
+        }
+    }
+    if (offsets_[vocab_count_] > bytes_size_){
+        throw std::runtime_error("Truncated vocabulary: " + path + ".vocab");
+    }
+}
+
+std::string_view TokenStreamReader::word(std::uint32_t id) const{
+    if (id >= vocab_count_){
+        throw std::out_of_range("token id out of range");
+    }
+    return std::string_view(bytes_ + offsets_[id], static_cast<std::size_t>(offsets_[id + 1] - offsets_[id]));
+}
\ No newline at end of file
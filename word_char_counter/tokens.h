@@ -0,0 +1,95 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "frequency.h"
+#include "input.h"
+#include "tokenize.h"
+
+// Token-id output for downstream tools, in two files:
+//
+//   PATH.ids    TokenStreamHeader, then count uint32 token ids
+//   PATH.vocab  TokenStreamHeader, then count + 1 uint64 offsets into the
+//               word bytes that follow (word i is [offsets[i], offsets[i+1]))
+//
+// Both headers are 64 bytes so the arrays behind them are aligned when the
+// files are mapped. Ids are dense and assigned in order of first appearance.
+
+constexpr char kTokenIdsMagic[8] = {'W', 'C', 'C', 'T', 'O', 'K', '\0', '\0'};
+constexpr char kVocabMagic[8] = {'W', 'C', 'C', 'V', 'O', 'C', '\0', '\0'};
+
+struct TokenStreamHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t count;
+    std::uint8_t padding[40];
+};
+
+// Tokenizes text with the count_words rule and appends the ids of its words
+// to PATH.ids through a large page-aligned buffer; PATH.vocab is written by
+// close(). Throws std::runtime_error on I/O errors.
+class TokenStreamWriter {
+public:
+    static constexpr std::size_t kBufferSize = std::size_t{1} << 20;
+
+    explicit TokenStreamWriter(const std::string& path);
+    ~TokenStreamWriter();
+    TokenStreamWriter(const TokenStreamWriter&) = delete;
+    TokenStreamWriter& operator=(const TokenStreamWriter&) = delete;
+
+    // Feeds one document in pieces; a word is never joined across two
+    // documents.
+    void feed(const char* data, std::size_t size);
+    void end_document();
+
+    void close();
+
+    std::uint64_t tokens() const { return tokens_; }
+    std::size_t vocabulary_size() const { return words_.size(); }
+
+private:
+    void add(std::string_view word);
+    void flush();
+
+    std::string path_;
+    int fd_ = -1;
+    std::unique_ptr<std::uint32_t[], void (*)(void*)> buffer_;
+    std::size_t buffered_ = 0;
+    std::uint64_t tokens_ = 0;
+    WordSplitter splitter_;
+
+    StringArena arena_;
+    std::unordered_map<std::string_view, std::uint32_t> ids_;
+    std::vector<std::string_view> words_;
+};
+
+// Maps a token stream written by TokenStreamWriter; ids() and word() point
+// straight into the mapped files.
+class TokenStreamReader {
+public:
+    // Throws std::runtime_error if either file is missing or malformed;
+    // every vocabulary offset is checked here, so word() cannot read out of
+    // bounds.
+    explicit TokenStreamReader(const std::string& path);
+
+    std::size_t size() const { return count_; }
+    const std::uint32_t* ids() const { return ids_; }
+
+    std::size_t vocabulary_size() const { return vocab_count_; }
+    std::string_view word(std::uint32_t id) const;
+
+private:
+    MappedFile ids_file_;
+    MappedFile vocab_file_;
+    const std::uint32_t* ids_ = nullptr;
+    std::size_t count_ = 0;
+    const std::uint64_t* offsets_ = nullptr;
+    const char* bytes_ = nullptr;
+    std::size_t bytes_size_ = 0;
+    std::size_t vocab_count_ = 0;
+};
\ No newline at end of file
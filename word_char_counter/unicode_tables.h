@@ -0,0 +1,11 @@
+#pragma once
+#include <cstddef>
+
+enum class CharCategory : unsigned char { Other = 0, Letter = 1, Digit = 2 };
+
+// General category of a code point, collapsed to letter (L*), decimal digit
+// (Nd) or other. Two table lookups, no branches on the code point value.
+CharCategory char_category(char32_t cp);
+
+// Simple lower-case mapping; code points without one map to themselves.
+char32_t to_lower(char32_t cp);
\ No newline at end of file
@@ -0,0 +1,321 @@
+#include "utf8.h"
+#include <algorithm>
+#include <utility>
+#include "unicode_tables.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Runs shorter than this are counted inline; the SIMD kernels have a fixed
+// setup cost that only pays off on longer stretches.
+constexpr std::size_t kMinKernelRun = 64;
+
+// Length of the leading run of ASCII bytes.
+std::size_t ascii_prefix(const unsigned char* p, std::size_t size){
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 32 <= size; i += 32){
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        const auto high = static_cast<std::uint32_t>(_mm256_movemask_epi8(v));
+        if (high != 0){
+            return i + static_cast<std::size_t>(__builtin_ctz(high));
+        }
+    }
+#elif defined(__SSE2__)
+    for (; i + 16 <= size; i += 16){
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const auto high = static_cast<std::uint32_t>(_mm_movemask_epi8(v));
+        if (high != 0){
+            return i + static_cast<std::size_t>(__builtin_ctz(high));
+        }
+    }
+#endif
+    while (i < size && p[i] < 0x80){
+        ++i;
+    }
+    return i;
+}
+
+// Decodes one multi-byte sequence starting at p[0] >= 0x80.
+// Returns its length, 0 if the bytes so far are a valid but truncated
+// prefix, or -1 if p[0] does not start a valid sequence.
+int decode(const unsigned char* p, std::size_t size, char32_t& cp){
+    const unsigned char lead = p[0];
+    int length;
+    unsigned char lo = 0x80;
+    unsigned char hi = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF){
+        length = 2;
+        cp = lead & 0x1F;
+    } else if (lead >= 0xE0 && lead <= 0xEF){
+        length = 3;
+        cp = lead & 0x0F;
+        if (lead == 0xE0) lo = 0xA0;        // overlong
+        if (lead == 0xED) hi = 0x9F;        // surrogates
+    } else if (lead >= 0xF0 && lead <= 0xF4){
+        length = 4;
+        cp = lead & 0x07;
+        if (lead == 0xF0) lo = 0x90;        // overlong
+        if (lead == 0xF4) hi = 0x8F;        // above U+10FFFF
+    } else {
+        return -1;
+    }
+    for (int i = 1; i < length; ++i){
+        if (static_cast<std::size_t>(i) >= size){
+            return 0;
+        }
+        const unsigned char c = p[i];
+        if (c < lo || c > hi){
+            return -1;
+        }
+        lo = 0x80;
+        hi = 0xBF;
+        cp = (cp << 6) | (c & 0x3F);
+    }
+    return length;
+}
+
+} // namespace
+
+void Utf8Counter::add_code_point(char32_t cp){
+    ++counts_.code_points;
+    const CharCategory category = char_category(cp);
+    if (category == CharCategory::Other){
+        in_word_ = false;
+        return;
+    }
+    if (category == CharCategory::Letter){
+        ++counts_.letters;
+    } else {
+        ++counts_.digits;
+    }
+    counts_.words += !in_word_;
+    in_word_ = true;
+    // Counted as seen; finish() lower-cases once per distinct code point.
+    if (cp < 0x10000){
+        if (bmp_.empty()){
+            bmp_.assign(0x10000, 0);
+        }
+        ++bmp_[cp];
+    } else {
+        ++astral_[cp];
+    }
+}
+
+void Utf8Counter::scan_ascii(const unsigned char* p, std::size_t size){
+    if (size >= kMinKernelRun){
+        counts_.words += count_word_starts(reinterpret_cast<const char*>(p), size, in_word_);
+        accumulate_histogram(reinterpret_cast<const char*>(p), size, ascii_);
+        return;
+    }
+    for (std::size_t i = 0; i < size; ++i){
+        const bool word = is_word_byte(p[i]);
+        counts_.words += word & !in_word_;
+        in_word_ = word;
+        ++ascii_[p[i]];
+    }
+}
+
+// Decodes multi-byte sequences up to the next ASCII byte and returns the
+// number of bytes consumed. A sequence cut off by the end of the buffer is
+// kept in pending_ for the next feed().
+std::size_t Utf8Counter::scan_non_ascii(const unsigned char* p, std::size_t size){
+    std::size_t i = 0;
+    while (i < size && p[i] >= 0x80){
+        char32_t cp = 0;
+        const int length = decode(p + i, size - i, cp);
+        if (length > 0){
+            add_code_point(cp);
+            i += static_cast<std::size_t>(length);
+        } else if (length == 0){
+            pending_size_ = size - i;
+            std::copy(p + i, p + size, pending_);
+            return size;
+        } else {
+            ++counts_.invalid;
+            in_word_ = false;
+            ++i;
+        }
+    }
+    return i;
+}
+
+// Finishes a sequence split by the previous chunk boundary; returns how many
+// bytes of p it used.
+std::size_t Utf8Counter::complete_pending(const unsigned char* p, std::size_t size){
+    unsigned char buffer[8];
+    std::copy(pending_, pending_ + pending_size_, buffer);
+    const std::size_t extra = std::min<std::size_t>(size, 4 - pending_size_);
+    std::copy(p, p + extra, buffer + pending_size_);
+
+    char32_t cp = 0;
+    const int length = decode(buffer, pending_size_ + extra, cp);
+    if (length == 0){
+        // Still incomplete: the whole of this (tiny) chunk belongs to it.
+        std::copy(p, p + size, pending_ + pending_size_);
+        pending_size_ += size;
+        return size;
+    }
+    const std::size_t held = pending_size_;
+    pending_size_ = 0;
+    if (length < 0){
+        // The held bytes were a lead byte and continuation bytes, each of
+        // which is invalid on its own; p is rescanned from the start.
+        counts_.invalid += held;
+        in_word_ = false;
+        return 0;
+    }
+    add_code_point(cp);
+    return static_cast<std::size_t>(length) - held;
+}
+
+void Utf8Counter::feed(const char* data, std::size_t size){
+    const auto* p = reinterpret_cast<const unsigned char*>(data);
+    std::size_t i = 0;
+    if (pending_size_ > 0){
+        i = complete_pending(p, size);
+    }
+    while (i < size){
+        const std::size_t ascii = ascii_prefix(p + i, size - i);
+        scan_ascii(p + i, ascii);
+        i += ascii;
+        i += scan_non_ascii(p + i, size - i);
+    }
+}
+
+Utf8Counts Utf8Counter::finish(){
+    counts_.invalid += pending_size_;
+    pending_size_ = 0;
+    in_word_ = false;
+
+    for (int b = 0; b < 0x80; ++b){
+        counts_.code_points += ascii_[b];
+    }
+    const ByteHistogram folded = fold_word_histogram(ascii_);
+    for (int b = 0; b < 0x80; ++b){
+        if (b >= '0' && b <= '9'){
+            counts_.digits += folded[b];
+        } else {
+            counts_.letters += folded[b];
+        }
+    }
+    ascii_ = ByteHistogram{};
+
+    if (bmp_.empty() && astral_.empty()){
+        counts_.chars.reserve(static_cast<std::size_t>(std::count_if(folded.begin(), folded.end(),
+            [](std::uint64_t count){ return count != 0; })));
+        for (int b = 0; b < 0x80; ++b){
+            if (folded[b] != 0){
+                counts_.chars.emplace_back(static_cast<char32_t>(b), folded[b]);
+            }
+        }
+    } else {
+        fold_code_points(folded);
+    }
+
+    Utf8Counts result = std::move(counts_);
+    counts_ = Utf8Counts{};
+    return result;
+}
+
+// Lower-cases the raw per-code-point counts and appends them to
+// counts_.chars. Non-ASCII code points can map to ASCII (KELVIN SIGN to 'k'),
+// so the ASCII counts are merged into the BMP table first. The simple
+// lower-case mapping is idempotent, so one pass over each table is enough.
+void Utf8Counter::fold_code_points(const ByteHistogram& ascii){
+    if (bmp_.empty()){
+        bmp_.assign(0x10000, 0);
+    }
+    for (int b = 0; b < 0x80; ++b){
+        bmp_[b] = ascii[b];
+    }
+    for (char32_t cp = 0x80; cp < 0x10000; ++cp){
+        const std::uint64_t count = bmp_[cp];
+        const char32_t lower = count != 0 ? to_lower(cp) : cp;
+        if (lower != cp){
+            bmp_[cp] = 0;
+            if (lower < 0x10000){
+                bmp_[lower] += count;
+            } else {
+                astral_[lower] += count;
+            }
+        }
+    }
+    std::vector<std::pair<char32_t, std::uint64_t>> astral;
+    for (const auto& [cp, count] : astral_){
+        const char32_t lower = to_lower(cp);
+        if (lower < 0x10000){
+            bmp_[lower] += count;
+        } else {
+            astral.emplace_back(lower, count);
+        }
+    }
+    std::sort(astral.begin(), astral.end());
+
+    std::size_t distinct = astral.size();
+    for (const std::uint64_t count : bmp_){
+        distinct += count != 0;
+    }
+    counts_.chars.reserve(distinct);
+    for (char32_t cp = 0; cp < 0x10000; ++cp){
+        if (bmp_[cp] != 0){
+            counts_.chars.emplace_back(cp, bmp_[cp]);
+        }
+    }
+    for (const auto& entry : astral){
+        // Two astral code points can share a lower-case form.
+        if (!counts_.chars.empty() && counts_.chars.back().first == entry.first){
+            counts_.chars.back().second += entry.second;
+        } else {
+            counts_.chars.push_back(entry);
+        }
+    }
+    // clear() keeps the table's capacity for the next round.
+    bmp_.clear();
+    astral_.clear();
+}
+
+Utf8Counts count_utf8(std::string_view text){
+    Utf8Counter counter;
+    counter.feed(text.data(), text.size());
+    return counter.finish();
+}
+
+void append_utf8(std::string& out, char32_t cp){
+    if (cp < 0x80){
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800){
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000){
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+bool is_valid_utf8(std::string_view text){
+    const auto* p = reinterpret_cast<const unsigned char*>(text.data());
+    const std::size_t size = text.size();
+    std::size_t i = 0;
+    while (i < size){
+        i += ascii_prefix(p + i, size - i);
+        while (i < size && p[i] >= 0x80){
+            char32_t cp = 0;
+            const int length = decode(p + i, size - i, cp);
+            if (length <= 0){
+                return false;
+            }
+            i += static_cast<std::size_t>(length);
+        }
+    }
+    return true;
+}
\ No newline at end of file
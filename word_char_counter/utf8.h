@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "scan.h"
+
+struct Utf8Counts {
+    std::uint64_t words = 0;        // runs of letters and digits
+    std::uint64_t code_points = 0;  // valid code points of any category
+    std::uint64_t letters = 0;
+    std::uint64_t digits = 0;
+    std::uint64_t invalid = 0;      // bytes that are not part of a valid sequence
+    // Letters and digits, lower-cased, with their counts, in code point order.
+    std::vector<std::pair<char32_t, std::uint64_t>> chars;
+};
+
+// Unicode-aware counterpart of count_words/count_char. A word is a run of
+// code points whose category is letter or decimal digit; invalid bytes end a
+// word and are counted separately. Runs of pure ASCII go through the same
+// SIMD kernels as count_words, so English text is not slowed down.
+class Utf8Counter {
+public:
+    void feed(const char* data, std::size_t size);
+    Utf8Counts finish();
+
+private:
+    void scan_ascii(const unsigned char* p, std::size_t size);
+    std::size_t scan_non_ascii(const unsigned char* p, std::size_t size);
+    std::size_t complete_pending(const unsigned char* p, std::size_t size);
+    void add_code_point(char32_t cp);
+    void fold_code_points(const ByteHistogram& ascii);
+
+    ByteHistogram ascii_{};
+    // Raw per-code-point counts of non-ASCII letters and digits: a flat table
+    // for the BMP, allocated on first use, and a map for the rare code points
+    // above it.
+    std::vector<std::uint64_t> bmp_;
+    std::unordered_map<char32_t, std::uint64_t> astral_;
+    Utf8Counts counts_;
+    bool in_word_ = false;
+    unsigned char pending_[4] = {};
+    std::size_t pending_size_ = 0;
+};
+
+Utf8Counts count_utf8(std::string_view text);
+
+// Appends the UTF-8 encoding of cp to out.
+void append_utf8(std::string& out, char32_t cp);
+
+// True if text is well-formed UTF-8 (no overlongs, surrogates or values
+// above U+10FFFF).
+bool is_valid_utf8(std::string_view text);
\ No newline at end of file
@@ -1,7 +1,72 @@
 #pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
 #include <unordered_map>
+#include "classify.h"
+#include "scan.h"
 
 int count_words(const std::string& text);
 
 std::unordered_map<char, int>
-count_char(const std::string& text);
\ No newline at end of file
+count_char(const std::string& text);
+
+// Approximate number of distinct words (HyperLogLog, see hll.h): a few KB
+// of memory whatever the input size, about 1.6% error at precision 12.
+std::uint64_t estimate_distinct_words(const std::string& text, unsigned precision = 12);
+
+// Lines, words, bytes, characters and longest line from one pass over text.
+TextStats count_text_stats(const std::string& text);
+
+// Variants with a custom token rule, e.g. count_words<AlnumUnderscorePolicy>.
+// See classify.h for the policies and how to define new ones.
+template <class Policy>
+int count_words(const std::string& text){
+    bool in_word = false;
+    return static_cast<int>(count_word_starts_as<Policy>(text.data(), text.size(), in_word));
+}
+
+template <class Policy>
+std::unordered_map<char, int>
+count_char(const std::string& text){
+    ByteHistogram hist{};
+    accumulate_histogram(text.data(), text.size(), hist);
+    const ByteHistogram folded = fold_histogram_as<Policy>(hist);
+    std::unordered_map<char, int> counts;
+    for (int b = 0; b < 256; ++b){
+        if (folded[b] != 0){
+            counts[static_cast<char>(b)] = static_cast<int>(folded[b]);
+        }
+    }
+    return counts;
+}
+
+// Same results as count_words/count_char, computed on several threads.
+// threads == 0 uses one per hardware thread.
+int count_words_parallel(const std::string& text, unsigned threads = 0);
+
+std::unordered_map<char, int>
+count_char_parallel(const std::string& text, unsigned threads = 0);
+
+struct WordCountSnapshot {
+    std::uint64_t words = 0;
+    std::uint64_t bytes = 0;
+    ByteHistogram chars{};   // word characters, upper case folded into lower
+};
+
+// Running totals over text that arrives in pieces (a growing log, a socket).
+// Only the in-word flag is carried between feed() calls, so a word split
+// across two chunks is counted once, memory use is constant and no byte is
+// scanned twice.
+class WordCounter {
+public:
+    void feed(std::string_view chunk);
+    WordCountSnapshot snapshot() const;
+    void reset();
+
+private:
+    std::uint64_t words_ = 0;
+    std::uint64_t bytes_ = 0;
+    ByteHistogram raw_{};
+    bool in_word_ = false;
+};
\ No newline at end of file
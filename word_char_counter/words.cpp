@@ -1,42 +1,67 @@
 #include <string>
-#include <sstream>
-#include <cctype>
 #include <unordered_map>
+#include "word.h"
+#include "scan.h"
+#include "parallel.h"
+#include "hll.h"
 
-std::unordered_map<char, int>
-count_char(const std::string& text){
+static std::unordered_map<char, int>
+to_char_map(const ByteHistogram& hist){
+    const ByteHistogram folded = fold_word_histogram(hist);
     std::unordered_map<char, int> counts;
-
-    for (char c : text){
-        auto cast_c = static_cast<unsigned char>(c);
-        if (std::isalnum(cast_c)){
-            char lower = std::tolower(cast_c);
-            counts[lower]++;
-        } 
+    for (int b = 0; b < 256; ++b){
+        if (folded[b] != 0){
+            counts[static_cast<char>(b)] = static_cast<int>(folded[b]);
+        }
     }
     return counts;
 }
 
+std::unordered_map<char, int>
+count_char(const std::string& text){
+    ByteHistogram hist{};
+    accumulate_histogram(text.data(), text.size(), hist);
+    return to_char_map(hist);
+}
+
 int count_words(const std::string& text){
-    std::string cleaned;
-    cleaned.reserve(text.size());
-
-    for (char c : text){
-        if (std::isalnum(static_cast<unsigned char>(c))){
-            cleaned += c;
-        } else {
-            cleaned += ' ';
-        }
-    }
+    bool in_word = false;
+    return static_cast<int>(count_word_starts(text.data(), text.size(), in_word));
+}
 
-    std::istringstream iss(cleaned);
+int count_words_parallel(const std::string& text, unsigned threads){
+    return static_cast<int>(count_parallel(text.data(), text.size(), threads).words);
+}
 
-    int count = 0;
-    std::string word;
-    while (iss >> word){
-        ++count;
-    }
+std::uint64_t estimate_distinct_words(const std::string& text, unsigned precision){
+    return sketch_distinct_words(text.data(), text.size(), precision).estimate();
+}
+
+TextStats count_text_stats(const std::string& text){
+    TextStats stats;
+    scan_text_stats(text.data(), text.size(), stats);
+    return stats;
+}
+
+std::unordered_map<char, int>
+count_char_parallel(const std::string& text, unsigned threads){
+    return to_char_map(count_parallel(text.data(), text.size(), threads).chars);
+}
+
+void WordCounter::feed(std::string_view chunk){
+    words_ += count_word_starts(chunk.data(), chunk.size(), in_word_);
+    accumulate_histogram(chunk.data(), chunk.size(), raw_);
+    bytes_ += chunk.size();
+}
 
-    return count;
+WordCountSnapshot WordCounter::snapshot() const{
+    WordCountSnapshot snap;
+    snap.words = words_;
+    snap.bytes = bytes_;
+    snap.chars = fold_word_histogram(raw_);
+    return snap;
 }
 
+void WordCounter::reset(){
+    *this = WordCounter{};
+}
\ No newline at end of file